@@ -6,6 +6,7 @@
 
 #include <assert.h>
 #include <stddef.h>
+#include <string.h>
 
 /* mbed TLS headers */
 #include <mbedtls/memory_buffer_alloc.h>
@@ -14,8 +15,102 @@
 #include <common/debug.h>
 #include <drivers/auth/mbedtls/mbedtls_common.h>
 #include <drivers/auth/mbedtls/mbedtls_config.h>
+#include <lib/utils_def.h>
 #include <plat/common/platform.h>
 
+#if TF_MBEDTLS_HEAP_ARENA
+/*
+ * Arena allocator. mbed TLS releases everything it allocates before a
+ * verification returns, so the heap is handed out as a bump allocator and
+ * rewound at the start of each verification. free() only gives memory back
+ * when it releases the most recent block, which covers the common
+ * alloc/free pairs inside a single operation.
+ */
+static struct {
+	unsigned char *base;
+	size_t size;
+	size_t top;		/* First free byte */
+	size_t last;		/* Offset of the most recent block */
+	size_t live;		/* Blocks not freed yet */
+	size_t step_peak;	/* Peak of the current verification */
+	size_t peak;		/* Peak since boot */
+} arena;
+
+static void *arena_calloc(size_t nmemb, size_t size)
+{
+	size_t len, top;
+	void *p;
+
+	if ((size != 0U) && (nmemb > (SIZE_MAX / size))) {
+		return NULL;
+	}
+	len = nmemb * size;
+	if (len == 0U) {
+		return NULL;
+	}
+
+	top = round_up(arena.top, (size_t)MBEDTLS_MEMORY_ALIGN_MULTIPLE);
+	if ((top > arena.size) || (len > (arena.size - top))) {
+		ERROR("mbed TLS heap exhausted (%zu + %zu > %zu)\n",
+		      top, len, arena.size);
+		return NULL;
+	}
+
+	p = arena.base + top;
+	arena.last = top;
+	arena.top = top + len;
+	arena.live++;
+
+	if (arena.top > arena.step_peak) {
+		arena.step_peak = arena.top;
+	}
+	if (arena.top > arena.peak) {
+		arena.peak = arena.top;
+	}
+
+	memset(p, 0, len);
+	return p;
+}
+
+static void arena_free(void *ptr)
+{
+	if (ptr == NULL) {
+		return;
+	}
+
+	assert(((unsigned char *)ptr >= arena.base) &&
+	       ((unsigned char *)ptr < (arena.base + arena.size)));
+	assert(arena.live > 0U);
+	arena.live--;
+
+	if ((unsigned char *)ptr == (arena.base + arena.last)) {
+		arena.top = arena.last;
+	}
+}
+
+/*
+ * Rewind the heap before a verification step. Every block of the previous
+ * step must have been released by then.
+ */
+void mbedtls_heap_step_begin(void)
+{
+	assert(arena.live == 0U);
+
+	arena.top = 0U;
+	arena.last = 0U;
+	arena.step_peak = 0U;
+}
+
+/*
+ * Report the heap usage of the step that just finished
+ */
+void mbedtls_heap_step_end(const char *step)
+{
+	INFO("mbed TLS heap: %s peak %zu, overall %zu of %zu bytes\n",
+	     step, arena.step_peak, arena.peak, arena.size);
+}
+#endif /* TF_MBEDTLS_HEAP_ARENA */
+
 static void cleanup(void)
 {
 	ERROR("EXIT from BL2\n");
@@ -46,7 +141,16 @@ void mbedtls_init(void)
 		assert(heap_size >= TF_MBEDTLS_HEAP_SIZE);
 
 		/* Initialize the mbed TLS heap */
+#if TF_MBEDTLS_HEAP_ARENA
+		arena.base = heap_addr;
+		arena.size = heap_size;
+		if (mbedtls_platform_set_calloc_free(arena_calloc,
+						     arena_free) != 0) {
+			panic();
+		}
+#else
 		mbedtls_memory_buffer_alloc_init(heap_addr, heap_size);
+#endif
 
 #ifdef MBEDTLS_PLATFORM_SNPRINTF_ALT
 		mbedtls_platform_set_snprintf(snprintf);
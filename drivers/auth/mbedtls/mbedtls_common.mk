@@ -100,6 +100,11 @@ else
     $(error "TF_MBEDTLS_KEY_ALG=${TF_MBEDTLS_KEY_ALG} not supported on mbed TLS")
 endif
 
+# Use the arena allocator for the mbed TLS heap and report its peak usage
+# after each verification step. The platform may also size the heap itself
+# through TF_MBEDTLS_HEAP_SIZE.
+TF_MBEDTLS_HEAP_ARENA	?=	0
+
 ifeq (${DECRYPTION_SUPPORT}, aes_gcm)
     TF_MBEDTLS_USE_AES_GCM	:=	1
 else
@@ -111,6 +116,11 @@ $(eval $(call add_define,TF_MBEDTLS_KEY_ALG_ID))
 $(eval $(call add_define,TF_MBEDTLS_KEY_SIZE))
 $(eval $(call add_define,TF_MBEDTLS_HASH_ALG_ID))
 $(eval $(call add_define,TF_MBEDTLS_USE_AES_GCM))
+$(eval $(call assert_boolean,TF_MBEDTLS_HEAP_ARENA))
+$(eval $(call add_define,TF_MBEDTLS_HEAP_ARENA))
+ifneq (${TF_MBEDTLS_HEAP_SIZE},)
+$(eval $(call add_define,TF_MBEDTLS_HEAP_SIZE))
+endif
 
 # Set definitions for measured boot driver
 $(eval $(call add_define,MBEDTLS_MD_ID))
@@ -72,6 +72,8 @@ static int verify_signature(void *data_ptr, unsigned int data_len,
 	unsigned char *p, *end;
 	unsigned char hash[MBEDTLS_MD_MAX_SIZE];
 
+	mbedtls_heap_step_begin();
+
 	/* Get pointers to signature OID and parameters */
 	p = (unsigned char *)sig_alg;
 	end = (unsigned char *)(p + sig_alg_len);
@@ -136,6 +138,7 @@ end1:
 	mbedtls_pk_free(&pk);
 end2:
 	mbedtls_free(sig_opts);
+	mbedtls_heap_step_end("signature");
 	return rc;
 }
 
@@ -250,6 +253,7 @@ static int aes_gcm_decrypt(void *data_ptr, size_t len, const void *key,
 	size_t dec_len;
 	int diff, i, rc;
 
+	mbedtls_heap_step_begin();
 	mbedtls_gcm_init(&ctx);
 
 	rc = mbedtls_gcm_setkey(&ctx, cipher, key, key_len * 8);
@@ -298,6 +302,7 @@ static int aes_gcm_decrypt(void *data_ptr, size_t len, const void *key,
 
 exit_gcm:
 	mbedtls_gcm_free(&ctx);
+	mbedtls_heap_step_end("decryption");
 	return rc;
 }
 
@@ -32,6 +32,19 @@
 
 #define LIB_NAME	"mbed TLS X509v3"
 
+/*
+ * Extension fast path. Certificates generated by tools/cert_create always
+ * carry the same extensions in the same order, so the position at which an
+ * OID was found once is a good guess for the next certificate. The extension
+ * table below is filled during the integrity check and the hints remember,
+ * for each OID cookie, the index and DER encoding of the extension found last
+ * time. A hint is only used if the DER OID at that index matches; otherwise
+ * the full parser is run and the hint is refreshed.
+ */
+#define MAX_EXT_ENTRIES			12
+#define MAX_EXT_HINTS			16
+#define MAX_OID_DER_LEN			16
+
 /* Temporary variables to speed up the authentication parameters search. These
  * variables are assigned once during the integrity check and used any time an
  * authentication parameter is requested, so we do not have to parse the image
@@ -42,6 +55,29 @@ static mbedtls_asn1_buf pk;
 static mbedtls_asn1_buf sig_alg;
 static mbedtls_asn1_buf signature;
 
+typedef struct ext_entry_s {
+	const unsigned char *oid;
+	size_t oid_len;
+	unsigned char *data;
+	size_t data_len;
+} ext_entry_t;
+
+typedef struct ext_hint_s {
+	const char *cookie;
+	unsigned int idx;
+	size_t oid_len;
+	unsigned char oid[MAX_OID_DER_LEN];
+} ext_hint_t;
+
+/* Extensions of the current certificate, filled by cert_parse() */
+static ext_entry_t ext_tab[MAX_EXT_ENTRIES];
+static unsigned int ext_num;
+static int ext_tab_valid;
+
+/* Persistent across certificates, holds no pointer into the image */
+static ext_hint_t ext_hints[MAX_EXT_HINTS];
+static unsigned int ext_hint_num;
+
 /*
  * Clear all static temporary variables.
  */
@@ -58,6 +94,9 @@ static void clear_temp_vars(void)
 	ZERO_AND_CLEAN(pk);
 	ZERO_AND_CLEAN(sig_alg);
 	ZERO_AND_CLEAN(signature);
+	ZERO_AND_CLEAN(ext_tab);
+	ZERO_AND_CLEAN(ext_num);
+	ZERO_AND_CLEAN(ext_tab_valid);
 
 #undef ZERO_AND_CLEAN
 }
@@ -131,6 +170,119 @@ static int get_ext(const char *oid, void **ext, unsigned int *ext_len)
 }
 
 
+/*
+ * Look up an extension through the hint recorded for 'oid' by a previous
+ * certificate. Returns IMG_PARSER_ERR_NOT_FOUND if there is no usable hint,
+ * the extension at the hinted position has a different OID, or an earlier
+ * extension has the same OID: get_ext() returns the first match, so a
+ * repeated OID must go through it.
+ */
+static int get_ext_fast(const char *oid, void **ext, unsigned int *ext_len)
+{
+	const ext_hint_t *hint;
+	const ext_entry_t *e;
+	unsigned int i, j;
+
+	if (ext_tab_valid == 0) {
+		return IMG_PARSER_ERR_NOT_FOUND;
+	}
+
+	for (i = 0U; i < ext_hint_num; i++) {
+		hint = &ext_hints[i];
+		if (hint->cookie != oid) {
+			continue;
+		}
+		if (hint->idx >= ext_num) {
+			break;
+		}
+		e = &ext_tab[hint->idx];
+		if ((e->oid_len != hint->oid_len) ||
+		    (memcmp(e->oid, hint->oid, hint->oid_len) != 0)) {
+			break;
+		}
+		for (j = 0U; j < hint->idx; j++) {
+			if ((ext_tab[j].oid_len == hint->oid_len) &&
+			    (memcmp(ext_tab[j].oid, hint->oid,
+				    hint->oid_len) == 0)) {
+				return IMG_PARSER_ERR_NOT_FOUND;
+			}
+		}
+		*ext = (void *)e->data;
+		*ext_len = (unsigned int)e->data_len;
+		return IMG_PARSER_OK;
+	}
+
+	return IMG_PARSER_ERR_NOT_FOUND;
+}
+
+/*
+ * Record where the full parser found 'oid' so the next certificate with the
+ * same layout can take the fast path.
+ */
+static void ext_hint_update(const char *oid, const void *ext)
+{
+	ext_hint_t *hint = NULL;
+	const ext_entry_t *e;
+	unsigned int i, idx;
+
+	if (ext_tab_valid == 0) {
+		return;
+	}
+
+	for (idx = 0U; idx < ext_num; idx++) {
+		if (ext_tab[idx].data == ext) {
+			break;
+		}
+	}
+	if (idx == ext_num) {
+		return;
+	}
+	e = &ext_tab[idx];
+	if (e->oid_len > MAX_OID_DER_LEN) {
+		return;
+	}
+
+	for (i = 0U; i < ext_hint_num; i++) {
+		if (ext_hints[i].cookie == oid) {
+			hint = &ext_hints[i];
+			break;
+		}
+	}
+	if (hint == NULL) {
+		if (ext_hint_num == MAX_EXT_HINTS) {
+			return;
+		}
+		hint = &ext_hints[ext_hint_num++];
+		hint->cookie = oid;
+	}
+
+	hint->idx = idx;
+	hint->oid_len = e->oid_len;
+	memcpy(hint->oid, e->oid, e->oid_len);
+}
+
+/*
+ * Get X509v3 extension, trying the fast path first
+ */
+static int find_ext(const char *oid, void **ext, unsigned int *ext_len)
+{
+	int rc;
+
+	assert(oid != NULL);
+
+	rc = get_ext_fast(oid, ext, ext_len);
+	if (rc == IMG_PARSER_OK) {
+		return rc;
+	}
+
+	rc = get_ext(oid, ext, ext_len);
+	if (rc == IMG_PARSER_OK) {
+		ext_hint_update(oid, *ext);
+	}
+
+	return rc;
+}
+
 /*
  * Check the integrity of the certificate ASN.1 structure.
  *
@@ -310,8 +462,10 @@ static int cert_parse(void *img, unsigned int img_len)
 	v3_ext.len = (p + len) - v3_ext.p;
 
 	/*
-	 * Check extensions integrity
+	 * Check extensions integrity and fill the extension table
 	 */
+	ext_num = 0U;
+	ext_tab_valid = 1;
 	while (p < end) {
 		ret = mbedtls_asn1_get_tag(&p, end, &len,
 					   MBEDTLS_ASN1_CONSTRUCTED |
@@ -325,6 +479,12 @@ static int cert_parse(void *img, unsigned int img_len)
 		if (ret != 0) {
 			return IMG_PARSER_ERR_FORMAT;
 		}
+		if (ext_num < MAX_EXT_ENTRIES) {
+			ext_tab[ext_num].oid = p;
+			ext_tab[ext_num].oid_len = len;
+		} else {
+			ext_tab_valid = 0;
+		}
 		p += len;
 
 		/* Get optional critical */
@@ -339,6 +499,11 @@ static int cert_parse(void *img, unsigned int img_len)
 		if (ret != 0) {
 			return IMG_PARSER_ERR_FORMAT;
 		}
+		if (ext_num < MAX_EXT_ENTRIES) {
+			ext_tab[ext_num].data = p;
+			ext_tab[ext_num].data_len = len;
+			ext_num++;
+		}
 		p += len;
 	}
 
@@ -444,12 +609,12 @@ static int get_auth_param(const auth_param_type_desc_t *type_desc,
 	case AUTH_PARAM_HASH:
 	case AUTH_PARAM_NV_CTR:
 		/* All these parameters are included as X509v3 extensions */
-		rc = get_ext(type_desc->cookie, param, param_len);
+		rc = find_ext(type_desc->cookie, param, param_len);
 		break;
 	case AUTH_PARAM_PUB_KEY:
 		if (type_desc->cookie != 0) {
 			/* Get public key from extension */
-			rc = get_ext(type_desc->cookie, param, param_len);
+			rc = find_ext(type_desc->cookie, param, param_len);
 		} else {
 			/* Get the subject public key */
 			*param = (void *)pk.p;
@@ -15,6 +15,7 @@
 #include <drivers/io/io_driver.h>
 #include <drivers/io/io_storage.h>
 #include <lib/utils.h>
+#include <lib/utils_def.h>
 
 typedef struct {
 	io_block_dev_spec_t	*dev_spec;
@@ -240,6 +241,12 @@ static int block_seek(io_entity_t *entity, int mode, signed long long offset)
  *
  * Additionally, the IO driver has an underlying buffer that is at least
  * one block-size and may be big enough to allow.
+ *
+ * If the device sets IO_BLOCK_FLAG_DIRECT_READ, any iteration that starts
+ * on a block boundary and whose destination is cache line aligned reads
+ * the whole blocks it covers straight into the caller buffer. Only the
+ * unaligned head and tail of the request then go through the underlying
+ * buffer and memcpy.
  */
 static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		      size_t *length_read)
@@ -296,6 +303,31 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		 */
 		lba = (cur->file_pos + cur->base) / block_size;
 
+		if (((cur->dev_spec->flags & IO_BLOCK_FLAG_DIRECT_READ) != 0U) &&
+		    (skip == 0U) && (left >= block_size) &&
+		    (((buffer + count) & (CACHE_WRITEBACK_GRANULE - 1U)) == 0U)) {
+			/*
+			 * Read the whole blocks straight into the user
+			 * buffer. Keep the request within the size of the
+			 * underlying buffer since that is the largest
+			 * transfer the low level driver is set up for.
+			 */
+			request = MIN(left & ~(block_size - 1U), buf->length);
+			nbytes = ops->read(lba, buffer + count, request);
+			nbytes &= ~(block_size - 1U);
+			if (nbytes == 0U) {
+				return -EIO;
+			}
+
+			if (ops->read_done != NULL) {
+				ops->read_done(buffer + count, nbytes);
+			}
+
+			cur->file_pos += nbytes;
+			count += nbytes;
+			continue;
+		}
+
 		if ((skip + left) > buf->length) {
 			/*
 			 * The underlying read buffer is too small to
@@ -338,6 +370,10 @@ static int block_read(io_entity_t *entity, uintptr_t buffer, size_t length,
 		       (void *)(buf->offset + skip),
 		       nbytes);
 
+		if (ops->read_done != NULL) {
+			ops->read_done(buffer + count, nbytes);
+		}
+
 		cur->file_pos += nbytes;
 		count += nbytes;
 	}
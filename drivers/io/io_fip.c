@@ -6,6 +6,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -25,6 +26,10 @@
 #define MAX_FIP_DEVICES		1
 #endif
 
+#ifndef MAX_FIP_TOC_ENTRIES
+#define MAX_FIP_TOC_ENTRIES	32
+#endif
+
 /* Useful for printing UUIDs when debugging.*/
 #define PRINT_UUID2(x)								\
 	"%08x-%04hx-%04hx-%02hhx%02hhx-%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx",	\
@@ -49,6 +54,27 @@ typedef struct {
 	uint16_t plat_toc_flag;
 } fip_dev_state_t;
 
+/*
+ * Copy of the FIP header and Table of Contents read from the backend by
+ * fip_dev_init(). One extra entry is reserved for the ToC end marker.
+ */
+typedef struct {
+	fip_toc_header_t header;
+	fip_toc_entry_t entries[MAX_FIP_TOC_ENTRIES + 1];
+} fip_toc_t;
+
+/*
+ * Index of the ToC entries, sorted by UUID, used by fip_file_open() instead
+ * of scanning the ToC on the backend each time an image is opened. It is
+ * rebuilt every time the FIP device is initialised and dropped when the
+ * device is closed. If the ToC does not fit, the index stays invalid and
+ * fip_file_open() scans the backend as before.
+ */
+typedef struct {
+	bool valid;
+	unsigned int num_entries;
+} fip_toc_index_t;
+
 static const uuid_t uuid_null;
 /*
  * Only one file can be open across all FIP device
@@ -61,6 +87,9 @@ static file_state_t current_file = {0};
 static uintptr_t backend_dev_handle;
 static uintptr_t backend_image_spec;
 
+static fip_toc_t toc;
+static fip_toc_index_t toc_index;
+
 static fip_dev_state_t state_pool[MAX_FIP_DEVICES];
 static io_dev_info_t dev_info_pool[MAX_FIP_DEVICES];
 
@@ -96,6 +125,73 @@ static inline int is_valid_header(fip_toc_header_t *header)
 }
 
 
+/*
+ * Sort the entries read into the ToC copy by UUID and mark the index valid.
+ * Returns without building the index if no end marker is found within
+ * MAX_FIP_TOC_ENTRIES entries.
+ */
+static void fip_toc_index_build(void)
+{
+	fip_toc_entry_t entry;
+	unsigned int num_entries;
+	unsigned int i, j;
+
+	toc_index.valid = false;
+
+	for (num_entries = 0U; num_entries <= MAX_FIP_TOC_ENTRIES;
+	     num_entries++) {
+		if (compare_uuids(&toc.entries[num_entries].uuid,
+				  &uuid_null) == 0) {
+			break;
+		}
+	}
+
+	if (num_entries > MAX_FIP_TOC_ENTRIES) {
+		WARN("FIP ToC exceeds %u entries, not cached\n",
+		     MAX_FIP_TOC_ENTRIES);
+		return;
+	}
+
+	/* Insertion sort: the ToC only holds a few dozen entries at most */
+	for (i = 1U; i < num_entries; i++) {
+		entry = toc.entries[i];
+		for (j = i; j > 0U; j--) {
+			if (compare_uuids(&toc.entries[j - 1U].uuid,
+					  &entry.uuid) <= 0) {
+				break;
+			}
+			toc.entries[j] = toc.entries[j - 1U];
+		}
+		toc.entries[j] = entry;
+	}
+
+	toc_index.num_entries = num_entries;
+	toc_index.valid = true;
+}
+
+/* Binary search the ToC index for an entry. Returns NULL if not present. */
+static const fip_toc_entry_t *fip_toc_index_find(const uuid_t *uuid)
+{
+	unsigned int low = 0U;
+	unsigned int high = toc_index.num_entries;
+	unsigned int mid;
+	int result;
+
+	while (low < high) {
+		mid = low + ((high - low) / 2U);
+		result = compare_uuids(&toc.entries[mid].uuid, uuid);
+		if (result == 0) {
+			return &toc.entries[mid];
+		} else if (result < 0) {
+			low = mid + 1U;
+		} else {
+			high = mid;
+		}
+	}
+
+	return NULL;
+}
+
 /* Identify the device type as a virtual driver */
 static io_type_t device_type_fip(void)
 {
@@ -213,13 +309,15 @@ static int fip_dev_open(const uintptr_t dev_spec,
 }
 
 
-/* Do some basic package checks. */
+/*
+ * Do some basic package checks and cache the Table of Contents. The header
+ * and the ToC are fetched with a single backend read.
+ */
 static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 {
 	int result;
 	unsigned int image_id = (unsigned int)init_params;
 	uintptr_t backend_handle;
-	fip_toc_header_t header;
 	size_t bytes_read;
 	fip_dev_state_t *state;
 
@@ -227,6 +325,9 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 
 	state = (fip_dev_state_t *)dev_info->info;
 
+	/* Drop the previous ToC index, the backend may have changed */
+	toc_index.valid = false;
+
 	/* Obtain a reference to the image by querying the platform layer */
 	result = plat_get_image_source(image_id, &backend_dev_handle,
 				       &backend_image_spec);
@@ -246,10 +347,10 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 		goto fip_dev_init_exit;
 	}
 
-	result = io_read(backend_handle, (uintptr_t)&header, sizeof(header),
+	result = io_read(backend_handle, (uintptr_t)&toc, sizeof(toc),
 			&bytes_read);
 	if (result == 0) {
-		if (!is_valid_header(&header)) {
+		if (!is_valid_header(&toc.header)) {
 			WARN("Firmware Image Package header check failed.\n");
 			result = -ENOENT;
 		} else {
@@ -258,7 +359,10 @@ static int fip_dev_init(io_dev_info_t *dev_info, const uintptr_t init_params)
 			 * Store 16-bit Platform ToC flags field which occupies
 			 * bits [32-47] in fip header.
 			 */
-			state->plat_toc_flag = (header.flags >> 32) & 0xffff;
+			state->plat_toc_flag = (toc.header.flags >> 32) & 0xffff;
+			if (bytes_read == sizeof(toc)) {
+				fip_toc_index_build();
+			}
 		}
 	}
 
@@ -276,6 +380,7 @@ static int fip_dev_close(io_dev_info_t *dev_info)
 	/* Clear the backend. */
 	backend_dev_handle = (uintptr_t)NULL;
 	backend_image_spec = (uintptr_t)NULL;
+	toc_index.valid = false;
 
 	return free_dev_info(dev_info);
 }
@@ -288,6 +393,7 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 	int result;
 	uintptr_t backend_handle;
 	const io_uuid_spec_t *uuid_spec = (io_uuid_spec_t *)spec;
+	const fip_toc_entry_t *toc_entry;
 	size_t bytes_read;
 	int found_file = 0;
 
@@ -305,6 +411,19 @@ static int fip_file_open(io_dev_info_t *dev_info, const uintptr_t spec,
 		return -ENOMEM;
 	}
 
+	/* Look the file up in the cached ToC if there is one */
+	if (toc_index.valid) {
+		toc_entry = fip_toc_index_find(&uuid_spec->uuid);
+		if (toc_entry == NULL) {
+			return -ENOENT;
+		}
+
+		current_file.entry = *toc_entry;
+		current_file.file_pos = 0;
+		entity->info = (uintptr_t)&current_file;
+		return 0;
+	}
+
 	/* Attempt to access the FIP image */
 	result = io_open(backend_dev_handle, backend_image_spec,
 			 &backend_handle);
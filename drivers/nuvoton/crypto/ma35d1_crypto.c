@@ -5,11 +5,13 @@
  */
 
 #include <assert.h>
+#include <errno.h>
 #include <stddef.h>
 #include <string.h>
 
 #include <common/debug.h>
 #include <drivers/auth/crypto_mod.h>
+#include <drivers/delay_timer.h>
 #include <plat/common/platform.h>
 #include <plat/common/common_def.h>
 #include <platform_def.h>
@@ -37,176 +39,221 @@
 #define MODOP_MUL           (0x1UL << ECC_CTL_MODOP_OFFSET)
 #define MODOP_ADD           (0x2UL << ECC_CTL_MODOP_OFFSET)
 #define MODOP_SUB           (0x3UL << ECC_CTL_MODOP_OFFSET)
-/*-----------------------------------------------------*/
-/*  Define elliptic curve (EC):                        */
-/*-----------------------------------------------------*/
-enum
+const char  hex_char_tbl[] = "0123456789abcdef";
+
+void hex_to_string(unsigned char *hex, int count, char *str)
 {
-	CURVE_GF_P,
-	CURVE_GF_2M,
+	for (; count > 0; hex++, count--) {
+		*str++ = hex_char_tbl[(*hex >> 4) & 0xf];
+		*str++ = hex_char_tbl[*hex & 0xf];
+	}
+	*str = 0;
+}
+
+/*
+ * NIST prime curve constants as ECC register limbs, least significant
+ * word first.
+ */
+static const uint32_t p256_a[8] = {
+	0xfffffffcUL, 0xffffffffUL, 0xffffffffUL, 0x00000000UL,
+	0x00000000UL, 0x00000000UL, 0x00000001UL, 0xffffffffUL
+};
+static const uint32_t p256_b[8] = {
+	0x27d2604bUL, 0x3bce3c3eUL, 0xcc53b0f6UL, 0x651d06b0UL,
+	0x769886bcUL, 0xb3ebbd55UL, 0xaa3a93e7UL, 0x5ac635d8UL
+};
+static const uint32_t p256_gx[8] = {
+	0xd898c296UL, 0xf4a13945UL, 0x2deb33a0UL, 0x77037d81UL,
+	0x63a440f2UL, 0xf8bce6e5UL, 0xe12c4247UL, 0x6b17d1f2UL
+};
+static const uint32_t p256_gy[8] = {
+	0x37bf51f5UL, 0xcbb64068UL, 0x6b315eceUL, 0x2bce3357UL,
+	0x7c0f9e16UL, 0x8ee7eb4aUL, 0xfe1a7f9bUL, 0x4fe342e2UL
+};
+static const uint32_t p256_p[8] = {
+	0xffffffffUL, 0xffffffffUL, 0xffffffffUL, 0x00000000UL,
+	0x00000000UL, 0x00000000UL, 0x00000001UL, 0xffffffffUL
+};
+static const uint32_t p256_n[8] = {
+	0xfc632551UL, 0xf3b9cac2UL, 0xa7179e84UL, 0xbce6faadUL,
+	0xffffffffUL, 0xffffffffUL, 0x00000000UL, 0xffffffffUL
+};
+
+static const uint32_t p384_a[12] = {
+	0xfffffffcUL, 0x00000000UL, 0x00000000UL, 0xffffffffUL,
+	0xfffffffeUL, 0xffffffffUL, 0xffffffffUL, 0xffffffffUL,
+	0xffffffffUL, 0xffffffffUL, 0xffffffffUL, 0xffffffffUL
+};
+static const uint32_t p384_b[12] = {
+	0xd3ec2aefUL, 0x2a85c8edUL, 0x8a2ed19dUL, 0xc656398dUL,
+	0x5013875aUL, 0x0314088fUL, 0xfe814112UL, 0x181d9c6eUL,
+	0xe3f82d19UL, 0x988e056bUL, 0xe23ee7e4UL, 0xb3312fa7UL
+};
+static const uint32_t p384_gx[12] = {
+	0x72760ab7UL, 0x3a545e38UL, 0xbf55296cUL, 0x5502f25dUL,
+	0x82542a38UL, 0x59f741e0UL, 0x8ba79b98UL, 0x6e1d3b62UL,
+	0xf320ad74UL, 0x8eb1c71eUL, 0xbe8b0537UL, 0xaa87ca22UL
+};
+static const uint32_t p384_gy[12] = {
+	0x90ea0e5fUL, 0x7a431d7cUL, 0x1d7e819dUL, 0x0a60b1ceUL,
+	0xb5f0b8c0UL, 0xe9da3113UL, 0x289a147cUL, 0xf8f41dbdUL,
+	0x9292dc29UL, 0x5d9e98bfUL, 0x96262c6fUL, 0x3617de4aUL
+};
+static const uint32_t p384_p[12] = {
+	0xffffffffUL, 0x00000000UL, 0x00000000UL, 0xffffffffUL,
+	0xfffffffeUL, 0xffffffffUL, 0xffffffffUL, 0xffffffffUL,
+	0xffffffffUL, 0xffffffffUL, 0xffffffffUL, 0xffffffffUL
+};
+static const uint32_t p384_n[12] = {
+	0xccc52973UL, 0xecec196aUL, 0x48b0a77aUL, 0x581a0db2UL,
+	0xf4372ddfUL, 0xc7634d81UL, 0xffffffffUL, 0xffffffffUL,
+	0xffffffffUL, 0xffffffffUL, 0xffffffffUL, 0xffffffffUL
 };
 
-typedef struct e_curve_t
+typedef struct ecc_hw_curve_t
 {
-	int   Echar;
-	char  Ea[144];
-	char  Eb[144];
-	char  Px[144];
-	char  Py[144];
-	int   Epl;
-	char  Pp[176];
-	int   Eol;
-	char  Eorder[176];
-	int   key_len;
-	int   irreducible_k1;
-	int   irreducible_k2;
-	int   irreducible_k3;
-	int   GF;
-}  ECC_CURVE;
-
-
-static ECC_CURVE  *pCurve;
-const ECC_CURVE  Curve_P256 =
+	int   key_len;      /* bits, also the CURVEM field of ECC_CTL */
+	int   words;
+	const uint32_t *a;
+	const uint32_t *b;
+	const uint32_t *gx;
+	const uint32_t *gy;
+	const uint32_t *p;
+	const uint32_t *n;
+}  ECC_HW_CURVE;
+
+static const ECC_HW_CURVE  Curve_P256 =
 {
-	/* NIST: Curve P-256 : y^2=x^3-ax+b (mod p) */
-	64,     /* Echar */
-	"FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFC",  /* "0000000000000000000000000000000000000000000000000000000000000003" */
-	"5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b",
-	"6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
-	"4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5",
-	78,     /* Epl */
-	"FFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF",  /* "115792089210356248762697446949407573530086143415290314195533631308867097853951" */
-	78,     /* Eol */
-	"FFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551",  /* "115792089210356248762697446949407573529996955224135760342422259061068512044369" */
-	256,    /* key_len */
-	10,
-	5,
-	2,
-	CURVE_GF_P
+	256, 8, p256_a, p256_b, p256_gx, p256_gy, p256_p, p256_n
 };
 
-const char  hex_char_tbl[] = "0123456789abcdef";
+static const ECC_HW_CURVE  Curve_P384 =
+{
+	384, 12, p384_a, p384_b, p384_gx, p384_gy, p384_p, p384_n
+};
+
+static const ECC_HW_CURVE  *pCurve;
+
+/*
+ * Register banks currently holding a known value. run_ecc_codec() drops
+ * the banks an operation writes, so constants are only reloaded after
+ * they were actually clobbered.
+ */
+#define ECC_LD_A            (1U << 0)   /* A = curve a */
+#define ECC_LD_B            (1U << 1)   /* B = curve b */
+#define ECC_LD_N_PRIME      (1U << 2)   /* N = field prime p */
+#define ECC_LD_N_ORDER      (1U << 3)   /* N = curve order n */
+#define ECC_LD_X2Y2_ZERO    (1U << 4)   /* X2, Y2 cleared */
 
-static char  ch2hex(char ch)
+#define ECC_CLOBBER_MODULE  0U
+#define ECC_CLOBBER_POINT   ECC_LD_X2Y2_ZERO
+
+static unsigned int ecc_loaded;
+
+static void ecc_write_limbs(uintptr_t reg, const uint32_t *limbs, int count)
 {
-	if (ch <= '9')
-	{
-		ch = ch - '0';
-	}
-	else if ((ch <= 'z') && (ch >= 'a'))
-	{
-		ch = ch - 'a' + 10U;
-	}
-	else
-	{
-		ch = ch - 'A' + 10U;
-	}
-	return ch;
+	int  i;
+
+	for (i = 0; i < ECC_LIMBS; i++)
+		mmio_write_32(reg + (i * 4), (i < count) ? limbs[i] : 0UL);
 }
 
-void Hex2Reg(char input[], uintptr_t addr)
+static void ecc_load_n(unsigned int which)
 {
-	char      hex;
-	int       si, ri;
-	uint32_t  i, val32;
-	volatile uint32_t* reg = (volatile uint32_t*)addr;
+	if (ecc_loaded & which)
+		return;
 
-	si = (int)strlen(input) - 1;
-	ri = 0;
+	ecc_write_limbs(ECC_N(0), (which == ECC_LD_N_ORDER) ? pCurve->n : pCurve->p,
+			pCurve->words);
+	ecc_loaded &= ~(ECC_LD_N_PRIME | ECC_LD_N_ORDER);
+	ecc_loaded |= which;
+}
 
-	while (si >= 0)
-	{
-		val32 = 0UL;
-		for (i = 0UL; (i < 8UL) && (si >= 0); i++)
-		{
-			hex = ch2hex(input[si]);
-			val32 |= (uint32_t)hex << (i * 4UL);
-			si--;
-		}
-		reg[ri++] = val32;
-	}
+/* Curve parameters A, B and N = p for point operations */
+static void ecc_load_params(void)
+{
+	if (!(ecc_loaded & ECC_LD_A))
+		ecc_write_limbs(ECC_A(0), pCurve->a, pCurve->words);
+	if (!(ecc_loaded & ECC_LD_B))
+		ecc_write_limbs(ECC_B(0), pCurve->b, pCurve->words);
+	ecc_loaded |= ECC_LD_A | ECC_LD_B;
+	ecc_load_n(ECC_LD_N_PRIME);
 }
 
-void hex_to_string(unsigned char *hex, int count, char *str)
+static void ecc_clear_x2y2(void)
 {
-	for (; count > 0; hex++, count--) {
-		*str++ = hex_char_tbl[(*hex >> 4) & 0xf];
-		*str++ = hex_char_tbl[*hex & 0xf];
-	}
-	*str = 0;
+	if (ecc_loaded & ECC_LD_X2Y2_ZERO)
+		return;
+
+	ecc_write_limbs(ECC_X2(0), NULL, 0);
+	ecc_write_limbs(ECC_Y2(0), NULL, 0);
+	ecc_loaded |= ECC_LD_X2Y2_ZERO;
 }
 
+/* Curve parameters plus the base point G in X1, Y1 */
 static int ecc_init_curve(void)
 {
-	int  i, ret = 0;
+	ecc_load_params();
+	ecc_clear_x2y2();
 
-	pCurve = (ECC_CURVE  *)&Curve_P256;
-	if (pCurve == 0)
-	{
-		ret = -1;
-	}
+	ecc_write_limbs(ECC_X1(0), pCurve->gx, pCurve->words);
+	ecc_write_limbs(ECC_Y1(0), pCurve->gy, pCurve->words);
 
-	if (ret == 0)
-	{
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_A(i), 0UL);
-			mmio_write_32(ECC_B(i), 0UL);
-			mmio_write_32(ECC_X1(i), 0UL);
-			mmio_write_32(ECC_Y1(i), 0UL);
-			mmio_write_32(ECC_X2(i), 0UL);
-			mmio_write_32(ECC_Y2(i), 0UL);
-			mmio_write_32(ECC_N(i), 0UL);
-		}
+	return 0;
+}
 
-		Hex2Reg(pCurve->Ea, ECC_A(0));
-		Hex2Reg(pCurve->Eb, ECC_B(0));
-		Hex2Reg(pCurve->Px, ECC_X1(0));
-		Hex2Reg(pCurve->Py, ECC_Y1(0));
+/**
+  * @brief  Convert a big-endian byte string into ECC register limbs.
+  *         Limb 0 holds the least significant word, as the ECC_X1/Y1/K/N
+  *         register banks expect.
+  * @param[in]  bin     Big-endian operand
+  * @param[in]  len     Operand length in bytes, at most ECC_LIMBS * 4
+  * @param[out] limbs   ECC_LIMBS words
+  * @return None
+  */
+static void ecc_bin2limbs(const unsigned char *bin, int len, uint32_t *limbs)
+{
+	int  i;
 
-		if (pCurve->GF == (int)CURVE_GF_2M)
-		{
-			mmio_write_32(ECC_N(0), 0x1UL);
-			mmio_write_32(ECC_N((pCurve->key_len) / 32), \
-				mmio_read_32(ECC_N((pCurve->key_len) / 32)| (1UL << ((pCurve->key_len) % 32))));
-			mmio_write_32(ECC_N((pCurve->irreducible_k1) / 32), \
-				mmio_read_32(ECC_N((pCurve->irreducible_k1) / 32))|(1UL << ((pCurve->irreducible_k1) % 32)));
-			mmio_write_32(ECC_N((pCurve->irreducible_k2) / 32), \
-				mmio_read_32(ECC_N((pCurve->irreducible_k2) / 32))|(1UL << ((pCurve->irreducible_k2) % 32)));
-			mmio_write_32(ECC_N((pCurve->irreducible_k3) / 32),
-				mmio_read_32(ECC_N((pCurve->irreducible_k3) / 32))|(1UL << ((pCurve->irreducible_k3) % 32)));
-		}
-		else
-		{
-			Hex2Reg(pCurve->Pp, ECC_N(0));
-		}
-	}
-	return ret;
+	assert((len >= 0) && (len <= (ECC_LIMBS * 4)));
+
+	for (i = 0; i < ECC_LIMBS; i++)
+		limbs[i] = 0UL;
+
+	for (i = 0; i < len; i++)
+		limbs[i / 4] |= (uint32_t)bin[len - 1 - i] << ((i % 4) * 8);
 }
 
-static int ecc_strcmp(char *s1, char *s2)
+/**
+  * @brief  Load a big-endian binary operand into an ECC register bank.
+  * @param[in]  reg     First register of the bank, e.g. ECC_X1(0)
+  * @param[in]  bin     Big-endian operand
+  * @param[in]  len     Operand length in bytes
+  * @return None
+  */
+void ECC_Load_Bin(uintptr_t reg, const unsigned char *bin, int len)
 {
-	char  c1, c2;
+	uint32_t  limbs[ECC_LIMBS];
+	int  i;
 
-	while (*s1 == '0') s1++;
-	while (*s2 == '0') s2++;
+	ecc_bin2limbs(bin, len, limbs);
+	for (i = 0; i < ECC_LIMBS; i++)
+		mmio_write_32(reg + (i * 4), limbs[i]);
+}
 
-	for ( ; *s1 || *s2; s1++, s2++)
-	{
-		if ((*s1 >= 'A') && (*s1 <= 'Z'))
-			c1 = *s1 + 32;
-		else
-			c1 = *s1;
+/**
+  * @brief  Constant-time compare of an ECC register bank with limbs.
+  * @return 0 if equal, 1 otherwise.
+  */
+static int ecc_cmp_limbs(uintptr_t reg, const uint32_t *limbs)
+{
+	uint32_t  diff = 0UL;
+	int  i;
 
-		if ((*s2 >= 'A') && (*s2 <= 'Z'))
-			c2 = *s2 + 32;
-		else
-			c2 = *s2;
+	for (i = 0; i < ECC_LIMBS; i++)
+		diff |= mmio_read_32(reg + (i * 4)) ^ limbs[i];
 
-		if (c1 != c2)
-			return 1;
-	}
-	return 0;
+	return (diff != 0UL);
 }
 
 int wait_ECC_complete()
@@ -229,24 +276,13 @@ int wait_ECC_complete()
 
 static void run_ecc_codec(unsigned int mode)
 {
-
 	if ((mode & ECC_CTL_ECCOP_MASK) == ECCOP_MODULE)
-	{
-		mmio_write_32(ECC_CTL ,ECC_CTL_FSEL);
-	}
+		ecc_loaded &= ~ECC_CLOBBER_MODULE;
 	else
-	{
-		if (pCurve->GF == (int)CURVE_GF_2M)
-		{
-			/* point */
-			mmio_write_32(ECC_CTL, 0UL);
-		}
-		else
-		{
-			/* CURVE_GF_P */
-			mmio_write_32(ECC_CTL, ECC_CTL_FSEL);
-		}
-	}
+		ecc_loaded &= ~ECC_CLOBBER_POINT;
+
+	/* only prime field curves are supported */
+	mmio_write_32(ECC_CTL, ECC_CTL_FSEL);
 
 	mmio_write_32(ECC_CTL, mmio_read_32(ECC_CTL)|((unsigned int)pCurve->key_len << ECC_CTL_CURVEM_OFFSET) | mode | ECC_CTL_START);
 	wait_ECC_complete();
@@ -369,7 +405,12 @@ void SHA_Read(unsigned int u32Digest[])
 
 	i = (mmio_read_32(HMAC_CTL) & HMAC_CTL_OPMODE_MASK ) >> HMAC_CTL_OPMODE_OFFSET;
 	//i = (CRPT->HMAC_CTL & CRPT_HMAC_CTL_OPMODE_Msk) >> CRPT_HMAC_CTL_OPMODE_Pos;
-	wcnt = 8UL;
+	if (i == SHA_MODE_SHA512)
+		wcnt = 16UL;
+	else if (i == SHA_MODE_SHA384)
+		wcnt = 12UL;
+	else
+		wcnt = 8UL;
 
 	reg_addr = HMAC_DGST(0);
 	/* reg_addr = ((unsigned long)&(CRPT->HMAC_DGST[0]));*/
@@ -381,29 +422,152 @@ void SHA_Read(unsigned int u32Digest[])
 }
 
 /**
-  * @brief  ECDSA dogotal signature verification.
-  * @param[in]  crpt        Reference to Crypto module.
-  * @param[in]  ecc_curve   The pre-defined ECC curve.
-  * @param[in]  message     The hash value of source context.
-  * @param[in]  x_ksnum     -1:  do not use Key Store, instead, use <public_x> as input public key X
-  *                         x_ksnum >= 0x80: Use Key Store OTP key number "x_ksnum - 0x80" as input public key X
-  *                         x_ksnum >= 0:    Use Key Store SRAM key number x_ksnum as input public key X
-  * @param[in]  y_ksnum     -1:  do not use Key Store, instead, use <public_y> as input public key Y
-  *                         y_ksnum >= 0x80: Use Key Store OTP key number "y_ksnum - 0x80" as input public key Y
-  *                         y_ksnum >= 0:    Use Key Store SRAM key number y_ksnum as input public key Y
-  * @param[in]  R           R of the (R,S) pair digital signature
-  * @param[in]  S           S of the (R,S) pair digital signature
-  * @return  0    Success.
-  * @return  -1   "ecc_curve" value is invalid.
-  * @return  -2   Verification failed.
-  * @return  -3   KS error
+  * @brief  Wait for the SHA DMA started by SHA_Start() to complete.
+  * @return 0 on success, -EIO on a SHA error, -ETIMEDOUT on timeout.
+  */
+int SHA_Wait(void)
+{
+	uint64_t timeout = timeout_init_us(SHA_TIMEOUT_US);
+	unsigned int sts;
+
+	while (1)
+	{
+		sts = mmio_read_32(INTSTS);
+		if (sts & INTSTS_HMACEIF)
+		{
+			mmio_write_32(INTSTS, INTSTS_HMACIF | INTSTS_HMACEIF);
+			return -EIO;
+		}
+		if (sts & INTSTS_HMACIF)
+		{
+			mmio_write_32(INTSTS, INTSTS_HMACIF);
+			return 0;
+		}
+		if (timeout_elapsed(timeout))
+			return -ETIMEDOUT;
+	}
+}
+
+/**
+  * @brief  Set AES DMA transfer
+  * @param[in]  u32SrcAddr   AES DMA source address
+  * @param[in]  u32DstAddr   AES DMA destination address
+  * @param[in]  u32TransCnt  AES DMA transfer byte count
+  * @return None
+  */
+void AES_SetDMATransfer(unsigned int u32SrcAddr, unsigned int u32DstAddr,
+			unsigned int u32TransCnt)
+{
+	mmio_write_32(AES_SADDR, u32SrcAddr);
+	mmio_write_32(AES_DADDR, u32DstAddr);
+	mmio_write_32(AES_CNT, u32TransCnt);
+}
+
+/**
+  * @brief  Start AES encrypt/decrypt
+  * @param[in]  u32DMAMode  AES DMA control, including:
+  *         - \ref CRYPTO_DMA_ONE_SHOT   One shot AES encrypt/decrypt.
+  *         - \ref CRYPTO_DMA_FIRST      First block of a DMA cascade.
+  *         - \ref CRYPTO_DMA_CONTINUE   Continuous AES encrypt/decrypt.
+  *         - \ref CRYPTO_DMA_LAST       Last AES encrypt/decrypt of a series of AES_Start.
+  * @return None
+  */
+void AES_Start(unsigned int u32DMAMode)
+{
+	mmio_write_32(AES_CTL, mmio_read_32(AES_CTL)&~(0x7UL << AES_CTL_DMALAST_OFFSET));
+	mmio_write_32(AES_CTL, mmio_read_32(AES_CTL)|AES_CTL_START | (u32DMAMode << AES_CTL_DMALAST_OFFSET));
+}
+
+/**
+  * @brief  Wait for an AES DMA transfer started by AES_Start to finish.
+  * @return 0 on completion, -EIO on an engine error, -ETIMEDOUT otherwise
   */
-int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, char *S)
+int AES_Wait(void)
+{
+	uint64_t timeout = timeout_init_us(AES_TIMEOUT_US);
+	unsigned int sts;
+
+	while (1)
+	{
+		sts = mmio_read_32(INTSTS);
+		if (sts & INTSTS_AESEIF)
+		{
+			mmio_write_32(INTSTS, INTSTS_AESIF | INTSTS_AESEIF);
+			return -EIO;
+		}
+		if (sts & INTSTS_AESIF)
+		{
+			mmio_write_32(INTSTS, INTSTS_AESIF);
+			return 0;
+		}
+		if (timeout_elapsed(timeout))
+			return -ETIMEDOUT;
+	}
+}
+
+/**
+  * @brief  Generate a 256-bit random key with the PRNG.
+  * @param[in]  reseed      1: reload the seed from the TRNG before generating
+  * @param[out] u32RandKey  The eight words of the random key
+  * @return 0 on success, -ETIMEDOUT if the PRNG stays busy
+  */
+int PRNG_Generate256(int reseed, unsigned int u32RandKey[8])
+{
+	uint64_t timeout;
+	int i;
+
+	mmio_write_32(PRNG_CTL, (PRNG_KEY_SIZE_256 << PRNG_CTL_KEYSZ_OFFSET) |
+		      (reseed ? (PRNG_CTL_SEEDSRC | PRNG_CTL_SEEDRLD) : 0));
+	mmio_write_32(PRNG_CTL, mmio_read_32(PRNG_CTL) | PRNG_CTL_START);
+
+	timeout = timeout_init_us(PRNG_TIMEOUT_US);
+	while (mmio_read_32(PRNG_CTL) & PRNG_CTL_BUSY)
+	{
+		if (timeout_elapsed(timeout))
+			return -ETIMEDOUT;
+	}
+
+	for (i = 0; i < 8; i++)
+		u32RandKey[i] = mmio_read_32(PRNG_KEY(i));
+	mmio_write_32(INTSTS, INTSTS_PRNGIF);
+	return 0;
+}
+
+/* 1 if 0 < v < n for the current curve, v being a big-endian operand */
+static int ecc_in_range(const unsigned char *v, int len)
 {
-	char temp_hex_str[64];
+	uint32_t limbs[ECC_LIMBS];
+	uint32_t n, any = 0UL;
+	int i;
+
+	ecc_bin2limbs(v, len, limbs);
+	for (i = 0; i < ECC_LIMBS; i++)
+		any |= limbs[i];
+	if (any == 0UL)
+		return 0;
+
+	for (i = ECC_LIMBS - 1; i >= 0; i--)
+	{
+		n = (i < pCurve->words) ? pCurve->n[i] : 0UL;
+		if (limbs[i] != n)
+			return (limbs[i] < n);
+	}
+	return 0;
+}
+
+/*
+ * ECDSA verify on pCurve. The public key comes from the Key Store when
+ * ksxy is not zero, from (Qx, Qy) otherwise. Only the leftmost curve
+ * length bytes of a longer message digest are used.
+ */
+static int ecc_verify(const unsigned char *message, int msg_len, unsigned int ksxy,
+		      const unsigned char *Qx, const unsigned char *Qy,
+		      const unsigned char *R, const unsigned char *S)
+{
+	uint32_t r_limbs[ECC_LIMBS];
 	unsigned int temp_result1[18], temp_result2[18];
 	unsigned int temp_x[18], temp_y[18];
-	unsigned int ksxy;
+	int bytes = pCurve->key_len / 8;
 	int i, ret = 0;
 
 	/*
@@ -411,6 +575,8 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 	 *   2. Compute e = HASH (m), where HASH is the hashing algorithm in signature generation
 	 *      (1) Use SHA to calculate e
 	 */
+	if (!ecc_in_range(R, bytes) || !ecc_in_range(S, bytes))
+		return -2;
 
 	/*
 	 *   3. Compute w = s^-1 (mod n)
@@ -425,19 +591,16 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 	 *      (9) Read X1 registers to get w
 	 */
 
-	if (ecc_init_curve() != 0)
-	{
-		ret = -1;
-	}
+	/*
+	 * Nothing is known about the register banks on entry. The curve
+	 * parameters are only needed from step 5; steps 3 and 4 just use N.
+	 */
+	ecc_loaded = 0U;
 
 	if (ret == 0)
 	{
 		/*  3-(1) Write the curve order to N registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_N(i), 0UL);
-		}
-		Hex2Reg(pCurve->Eorder, ECC_N(0));
+		ecc_load_n(ECC_LD_N_ORDER);
 
 		/*  3-(2) Write 0x1 to Y1 registers */
 		for (i = 0; i < 18; i++)
@@ -447,11 +610,7 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		mmio_write_32(ECC_Y1(0), 0x1UL);
 
 		/*  3-(3) Write s to X1 registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_X1(i), 0UL);
-		}
-		Hex2Reg(S, ECC_X1(0));
+		ECC_Load_Bin(ECC_X1(0), S, bytes);
 
 		run_ecc_codec(ECCOP_MODULE | MODOP_DIV);
 
@@ -480,18 +639,10 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		 */
 
 		/*  4-(1) Write the curve order and curve length to N ,M registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_N(i), 0UL);
-		}
-		Hex2Reg(pCurve->Eorder, ECC_N(0));
+		ecc_load_n(ECC_LD_N_ORDER);
 
 		/* 4-(2) Write e, w to X1, Y1 registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_X1(i), 0UL);
-		}
-		Hex2Reg(message, ECC_X1(0));
+		ECC_Load_Bin(ECC_X1(0), message, MIN(msg_len, bytes));
 
 		for (i = 0; i < 18; i++)
 		{
@@ -507,18 +658,14 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		}
 
 		/*  4-(8) Write the curve order and curve length to N ,M registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_N(i), 0UL);
-		}
-		Hex2Reg(pCurve->Eorder, ECC_N(0));
+		ecc_load_n(ECC_LD_N_ORDER);
 
 		/* 4-(9) Write r, w to X1, Y1 registers */
+		ecc_bin2limbs(R, bytes, r_limbs);
 		for (i = 0; i < 18; i++)
 		{
-			mmio_write_32(ECC_X1(i), 0UL);
+			mmio_write_32(ECC_X1(i), r_limbs[i]);
 		}
-		Hex2Reg(R, ECC_X1(0));
 
 		for (i = 0; i < 18; i++)
 		{
@@ -588,49 +735,25 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		}
 
 		/* (8) Write the curve parameter A, B, N, and curve length M to corresponding registers */
-		ecc_init_curve();
+		ecc_load_params();
+		ecc_clear_x2y2();
 
 		/* (9) Write the public key Q(x,y) to X1, Y1 registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_X1(i), 0UL);
-			mmio_write_32(ECC_Y1(i), 0UL);
-		}
-
-		//Hex2Reg(public_k1, CRPT->ECC_X1);
-		//Hex2Reg(public_k2, CRPT->ECC_Y1);
-
-		ksxy = ECC_KSXY_RSRCXY;
-
-		if (x_ksnum >= 0x80)
-		{
-			ksxy |= (2<<ECC_KSXY_RSSRCX_OFFSET) | (x_ksnum - 0x80);
-		}
-		else if (x_ksnum >= 0)
+		if (ksxy != 0U)
 		{
-			ksxy |= (0<<ECC_KSXY_RSSRCX_OFFSET) | (x_ksnum);
+			for (i = 0; i < 18; i++)
+			{
+				mmio_write_32(ECC_X1(i), 0UL);
+				mmio_write_32(ECC_Y1(i), 0UL);
+			}
+			mmio_write_32(ECC_KSXY, ksxy);
 		}
 		else
 		{
-			printf("--> 1\n");
-			return -3;
+			ECC_Load_Bin(ECC_X1(0), Qx, bytes);
+			ECC_Load_Bin(ECC_Y1(0), Qy, bytes);
 		}
 
-		if (y_ksnum >= 0x80)
-		{
-			ksxy |= (2<<ECC_KSXY_RSSRCX_OFFSET) | ((y_ksnum - 0x80) << 8);
-		}
-		else if (y_ksnum >= 0)
-		{
-			ksxy |= (0<<ECC_KSXY_RSSRCX_OFFSET) | (y_ksnum << 8);
-		}
-		else
-		{
-			printf("--> 2\n");
-			return -3;
-		}
-		mmio_write_32(ECC_KSXY, ksxy);
-
 		/* (10) Write u2 to K registers */
 		for (i = 0; i < 18; i++)
 		{
@@ -647,7 +770,7 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		}
 
 		/* (14) Write the curve parameter A, B, N, and curve length M to corresponding registers */
-		ecc_init_curve();
+		ecc_load_params();
 
 		/* Write the result data u2*Q to X1, Y1 registers */
 		for (i = 0; i < 18; i++)
@@ -673,11 +796,7 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		}
 
 		/*  (20) Write the curve order and curve length to N ,M registers */
-		for (i = 0; i < 18; i++)
-		{
-			mmio_write_32(ECC_N(i),0UL);
-		}
-		Hex2Reg(pCurve->Eorder, ECC_N(0));
+		ecc_load_n(ECC_LD_N_ORDER);
 
 		/*
 		 *  (21) Write x1\A1\A6 to X1 registers
@@ -692,17 +811,91 @@ int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, cha
 		run_ecc_codec(ECCOP_MODULE | MODOP_ADD);
 
 		/*  (27) Read X1 registers to get x1\A1\A6 (mod n) */
-		Reg2Hex(pCurve->Echar, (unsigned int *)ECC_X1(0), temp_hex_str);
 
 		/* 6. The signature is valid if x1\A1\A6 = r, otherwise it is invalid */
 
 		/* Compare with test pattern to check if r is correct or not */
-		if (ecc_strcmp(temp_hex_str, R) != 0)
-		{
-			printf("--> 3\n");
+		if (ecc_cmp_limbs(ECC_X1(0), r_limbs) != 0)
 			ret = -2;
-		}
 	}  /* ret == 0 */
 
 	return ret;
 }
+
+/**
+  * @brief  ECDSA P-256 signature verification with a Key Store public key.
+  * @param[in]  message     The hash value of source context, 32 bytes big-endian.
+  * @param[in]  x_ksnum     x_ksnum >= 0x80: Use Key Store OTP key number "x_ksnum - 0x80" as input public key X
+  *                         x_ksnum >= 0:    Use Key Store SRAM key number x_ksnum as input public key X
+  * @param[in]  y_ksnum     y_ksnum >= 0x80: Use Key Store OTP key number "y_ksnum - 0x80" as input public key Y
+  *                         y_ksnum >= 0:    Use Key Store SRAM key number y_ksnum as input public key Y
+  * @param[in]  R           R of the (R,S) pair digital signature, 32 bytes big-endian
+  * @param[in]  S           S of the (R,S) pair digital signature, 32 bytes big-endian
+  * @return  0    Success.
+  * @return  -2   Verification failed.
+  * @return  -3   KS error
+  */
+int ECC_VerifySignature_KS(const unsigned char *message, int x_ksnum, int y_ksnum,
+			   const unsigned char *R, const unsigned char *S)
+{
+	unsigned int ksxy;
+
+	ksxy = ECC_KSXY_RSRCXY;
+
+	if (x_ksnum >= 0x80)
+	{
+		ksxy |= (2<<ECC_KSXY_RSSRCX_OFFSET) | (x_ksnum - 0x80);
+	}
+	else if (x_ksnum >= 0)
+	{
+		ksxy |= (0<<ECC_KSXY_RSSRCX_OFFSET) | (x_ksnum);
+	}
+	else
+	{
+		ERROR("ECC: invalid Key Store key number %d for Qx\n", x_ksnum);
+		return -3;
+	}
+
+	if (y_ksnum >= 0x80)
+	{
+		ksxy |= (2<<ECC_KSXY_RSSRCX_OFFSET) | ((y_ksnum - 0x80) << 8);
+	}
+	else if (y_ksnum >= 0)
+	{
+		ksxy |= (0<<ECC_KSXY_RSSRCX_OFFSET) | (y_ksnum << 8);
+	}
+	else
+	{
+		ERROR("ECC: invalid Key Store key number %d for Qy\n", y_ksnum);
+		return -3;
+	}
+
+	pCurve = &Curve_P256;
+	return ecc_verify(message, ECC_P256_BYTES, ksxy, NULL, NULL, R, S);
+}
+
+/**
+  * @brief  ECDSA signature verification with a public key from memory.
+  * @param[in]  key_len     Curve size in bits, 256 for P-256 or 384 for P-384.
+  * @param[in]  message     The hash value of source context, big-endian.
+  * @param[in]  msg_len     Length of message in bytes.
+  * @param[in]  Qx, Qy      Public key, key_len / 8 bytes each, big-endian.
+  * @param[in]  R, S        The (R,S) pair digital signature, key_len / 8 bytes
+  *                         each, big-endian.
+  * @return  0    Success.
+  * @return  -1   Unsupported curve.
+  * @return  -2   Verification failed.
+  */
+int ECC_VerifySignature(int key_len, const unsigned char *message, int msg_len,
+			const unsigned char *Qx, const unsigned char *Qy,
+			const unsigned char *R, const unsigned char *S)
+{
+	if (key_len == 256)
+		pCurve = &Curve_P256;
+	else if (key_len == 384)
+		pCurve = &Curve_P384;
+	else
+		return -1;
+
+	return ecc_verify(message, msg_len, 0U, Qx, Qy, R, S);
+}
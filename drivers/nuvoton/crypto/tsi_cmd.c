@@ -20,6 +20,7 @@
 #include <plat/common/common_def.h>
 #include <platform_def.h>
 #include <drivers/delay_timer.h>
+#include <lib/spinlock.h>
 
 #include <ma35d1_crypto.h>
 #include <whc.h>
@@ -53,6 +54,7 @@ ERR_CODE_T _err_code_tbl[] = {
 	{ ST_KS_FULL,              "ST_KS_FULL" },
 	{ ST_WHC_TX_BUSY,          "ST_WHC_TX_BUSY" },
 	{ ST_CMD_ACK_TIME_OUT,     "ST_CMD_ACK_TIME_OUT" },
+	{ ST_CMD_PENDING,          "ST_CMD_PENDING" },
 };
 
 void tsi_print_err_code(int code)
@@ -99,45 +101,187 @@ int tsi_send_command(TSI_REQ_T *req)
 	return 0;
 }
 
-int tsi_wait_ack(TSI_REQ_T *req, int time_out)
+/*
+ * Asynchronous requests. Up to TSI_MAX_INFLIGHT commands may be waiting for
+ * their ACK at once; the caller owns the TSI_REQ_T until it has completed.
+ * An ACK is matched to its command by class code, sub-code and session ID,
+ * so two in-flight commands must differ in at least one of them.
+ */
+static TSI_REQ_T *tsi_inflight[TSI_MAX_INFLIGHT];
+static spinlock_t tsi_lock;
+
+/*
+ * CHRs of cancelled requests whose ACK may still arrive. That ACK is
+ * dropped instead of being matched to a later request with the same CHR.
+ * When the list is full the oldest entry is reused.
+ */
+static uint32_t tsi_cancelled[TSI_MAX_INFLIGHT];
+static uint32_t tsi_cancelled_mask;
+static unsigned int tsi_cancelled_next;
+
+/* Drop a recorded cancellation for chr. Returns 1 if there was one. */
+static int tsi_uncancel(uint32_t chr)
+{
+	int	i;
+
+	for (i = 0; i < TSI_MAX_INFLIGHT; i++) {
+		if ((tsi_cancelled_mask & (1U << i)) &&
+		    (tsi_cancelled[i] == chr)) {
+			tsi_cancelled_mask &= ~(1U << i);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * @brief    Send a command without waiting for its ACK.
+ * @param[in]  req           The command. Must stay valid until completed.
+ * @return   0               command sent, see tsi_poll() and tsi_wait()
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int tsi_submit(TSI_REQ_T *req)
 {
-	int	i, t;
+	int	i, slot = -1;
+	int	ret = 0;
+
+	spin_lock(&tsi_lock);
+	for (i = 0; i < TSI_MAX_INFLIGHT; i++) {
+		if (tsi_inflight[i] == NULL) {
+			if (slot < 0)
+				slot = i;
+		} else if ((tsi_inflight[i]->cmd[0] & TCK_CHR_MASK) ==
+			   (req->cmd[0] & TCK_CHR_MASK)) {
+			/* the two ACKs could not be told apart */
+			slot = -1;
+			break;
+		}
+	}
 
-	for (t = 0; t < 2000; t++) {
-		for (i = 0; i < 4; i++) {
-			if (WHC1->RXSTS & (1 << i)) {	/* Check CHxRDY */
-				if ((WHC1->RMDAT[i][0] & TCK_CHR_MASK) ==
-					(req->cmd[0] & TCK_CHR_MASK)) {
+	if (slot < 0) {
+		ret = ST_CMD_QUEUE_FULL;
+	} else {
+		ret = tsi_send_command(req);
+		if (ret == 0) {
+			req->state = TREQ_ST_PROCESSING;
+			tsi_inflight[slot] = req;
+		}
+	}
+	spin_unlock(&tsi_lock);
+	return ret;
+}
 
-					req->ack[0] = WHC1->RMDAT[i][0];
-					req->ack[1] = WHC1->RMDAT[i][1];
-					req->ack[2] = WHC1->RMDAT[i][2];
-					req->ack[3] = WHC1->RMDAT[i][3];
-					WHC1->RXCTL = (1 << i);	/* set CHxACK */
+/*
+ * @brief    Collect the ACKs posted by TSI and complete their requests.
+ *           May be called from the WHC1 RX interrupt handler.
+ */
+void tsi_process_acks(void)
+{
+	TSI_REQ_T *req;
+	uint32_t chr;
+	int	i, j;
 
-					//printf("ACK: 0x%x 0x%x 0x%x 0x%x\n",
-					// req->ack[0], req->ack[1], req->ack[2], req->ack[3]);
-					return 0;
-				}
+	spin_lock(&tsi_lock);
+	for (i = 0; i < 4; i++) {
+		if (!(WHC1->RXSTS & (1 << i)))	/* Check CHxRDY */
+			continue;
+
+		chr = WHC1->RMDAT[i][0] & TCK_CHR_MASK;
+		j = TSI_MAX_INFLIGHT;
+		if (!tsi_uncancel(chr)) {
+			for (j = 0; j < TSI_MAX_INFLIGHT; j++) {
+				req = tsi_inflight[j];
+				if ((req != NULL) &&
+				    ((req->cmd[0] & TCK_CHR_MASK) == chr))
+					break;
 			}
 		}
-		mdelay(1);
+		if (j >= TSI_MAX_INFLIGHT) {
+			/* cancelled or unknown, free the channel and drop it */
+			WHC1->RXCTL = (1 << i);	/* set CHxACK */
+			continue;
+		}
+
+		req->ack[0] = WHC1->RMDAT[i][0];
+		req->ack[1] = WHC1->RMDAT[i][1];
+		req->ack[2] = WHC1->RMDAT[i][2];
+		req->ack[3] = WHC1->RMDAT[i][3];
+		WHC1->RXCTL = (1 << i);	/* set CHxACK */
+		req->state = TREQ_ST_ACK_SEND;
+		tsi_inflight[j] = NULL;
+	}
+	spin_unlock(&tsi_lock);
+}
+
+/*
+ * @brief    Check a request sent by tsi_submit().
+ * @param[in]  req           The command.
+ * @return   ST_CMD_PENDING  TSI has not acknowledged the command yet
+ * @return   otherwise       The ACK status, refer to ST_XXX error code.
+ */
+int tsi_poll(TSI_REQ_T *req)
+{
+	if (req->state == TREQ_ST_PROCESSING)
+		tsi_process_acks();
+	if (req->state == TREQ_ST_PROCESSING)
+		return ST_CMD_PENDING;
+	return TA_GET_STATUS(req);
+}
+
+/*
+ * @brief    Give up on a request sent by tsi_submit(). A late ACK is dropped.
+ * @param[in]  req           The command.
+ */
+void tsi_cancel(TSI_REQ_T *req)
+{
+	int	i;
+
+	spin_lock(&tsi_lock);
+	for (i = 0; i < TSI_MAX_INFLIGHT; i++) {
+		if (tsi_inflight[i] != req)
+			continue;
+
+		tsi_inflight[i] = NULL;
+		tsi_cancelled[tsi_cancelled_next] = req->cmd[0] & TCK_CHR_MASK;
+		tsi_cancelled_mask |= 1U << tsi_cancelled_next;
+		tsi_cancelled_next = (tsi_cancelled_next + 1U) % TSI_MAX_INFLIGHT;
+	}
+	req->state = TREQ_ST_UNUSED;
+	spin_unlock(&tsi_lock);
+}
+
+/*
+ * @brief    Wait for a request sent by tsi_submit() to complete.
+ * @param[in]  req           The command.
+ * @param[in]  time_out      Time limit, in units of 10 ms (CMD_TIME_OUT_XX).
+ * @return   0               success
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int tsi_wait(TSI_REQ_T *req, int time_out)
+{
+	uint64_t timeout = timeout_init_us((uint32_t)time_out * 10000U);
+	int	ret;
+
+	while (1) {
+		ret = tsi_poll(req);
+		if (ret != ST_CMD_PENDING)
+			return ret;
+		if (timeout_elapsed(timeout)) {
+			tsi_cancel(req);
+			return ST_CMD_ACK_TIME_OUT;
+		}
 	}
-	return ST_CMD_ACK_TIME_OUT;
 }
 
 int tsi_send_command_and_wait(TSI_REQ_T *req, int time_out)
 {
 	int ret;
 
-	ret = tsi_send_command(req);
+	ret = tsi_submit(req);
 	if (ret != 0)
 		return ret;
 
-	ret = tsi_wait_ack(req, time_out);
-	if (ret != 0)
-		return ret;
-	return TA_GET_STATUS(req);
+	return tsi_wait(req, time_out);
 }
 
 
@@ -149,10 +293,18 @@ int tsi_send_command_and_wait(TSI_REQ_T *req, int time_out)
 int TSI_Sync(void)
 {
 	TSI_REQ_T req;
+	int ret;
 
 	memset(&req, 0, sizeof(req));
 	req.cmd[0] = CMD_TSI_SYNC << 16;
-	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+	ret = tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+	if (ret == 0) {
+		/* TSI dropped everything in progress, no late ACKs will come */
+		spin_lock(&tsi_lock);
+		tsi_cancelled_mask = 0;
+		spin_unlock(&tsi_lock);
+	}
+	return ret;
 }
 
 
@@ -271,6 +423,83 @@ int TSI_Close_Session(int class_code, int session_id)
 }
 
 
+/*
+ * @brief    Initialize the TSI TRNG.
+ * @param[in]  method        0: Self-seeding
+ *                           1: Nonce seeding
+ *                           2: User seed
+ * @param[in]  pers_str_addr Address of the personalization string, or 0
+ * @return   0               success
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int TSI_TRNG_Init(int method, uint32_t pers_str_addr)
+{
+	TSI_REQ_T req;
+
+	memset(&req, 0, sizeof(req));
+	req.cmd[0] = (CMD_TRNG_INIT << 16) | method;
+	req.cmd[1] = pers_str_addr;
+	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+}
+
+
+/*
+ * @brief    Read random words from the TSI TRNG.
+ * @param[in]  wcnt          Word count of random data
+ * @param[in]  dest_addr     Destination address
+ * @return   0               success
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int TSI_TRNG_Gen_Random(uint32_t wcnt, uint32_t dest_addr)
+{
+	TSI_REQ_T req;
+
+	memset(&req, 0, sizeof(req));
+	req.cmd[0] = (CMD_TRNG_GEN_RANDOM << 16);
+	req.cmd[1] = wcnt;
+	req.cmd[2] = dest_addr;
+	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+}
+
+
+/*
+ * @brief    Reseed the TSI PRNG.
+ * @param[in]  seed_src      PRNG_SEED_FROM_TRNG: Seed is read from the TRNG
+ *                           PRNG_SEED_FROM_USER: Seed is <seed>
+ * @param[in]  seed          User seed, ignored for PRNG_SEED_FROM_TRNG
+ * @return   0               success
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int TSI_PRNG_ReSeed(int seed_src, uint32_t seed)
+{
+	TSI_REQ_T req;
+
+	memset(&req, 0, sizeof(req));
+	req.cmd[0] = (CMD_PRNG_RESEED << 16) | seed_src;
+	req.cmd[1] = seed;
+	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+}
+
+
+/*
+ * @brief    Generate random words with the TSI PRNG.
+ * @param[in]  wcnt          Word count of random data
+ * @param[in]  dest_addr     Destination address
+ * @return   0               success
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int TSI_PRNG_Gen_Random_Mass(uint32_t wcnt, uint32_t dest_addr)
+{
+	TSI_REQ_T req;
+
+	memset(&req, 0, sizeof(req));
+	req.cmd[0] = (CMD_PRNG_GEN_RAN_MASS << 16);
+	req.cmd[1] = wcnt;
+	req.cmd[2] = dest_addr;
+	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+}
+
+
 /*
  * @brief    Configure AES encrypt/decrypt mode.
  * @param[in]  sid           The session ID obtained from TSI_Open_Session().
@@ -392,13 +621,30 @@ int TSI_AES_Run(int sid, int is_last, int data_cnt, uint32_t src_addr,
 		uint32_t dest_addr)
 {
 	TSI_REQ_T req;
+	int ret;
 
-	memset(&req, 0, sizeof(req));
-	req.cmd[0] = (CMD_AES_RUN << 16) | sid;
-	req.cmd[1] = (is_last << 24) | data_cnt;
-	req.cmd[2] = src_addr;
-	req.cmd[3] = dest_addr;
-	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+	ret = TSI_AES_Run_Async(&req, sid, is_last, data_cnt, src_addr, dest_addr);
+	if (ret != 0)
+		return ret;
+	return tsi_wait(&req, CMD_TIME_OUT_2S);
+}
+
+/*
+ * @brief    Same as TSI_AES_Run(), but return once the command is sent.
+ *           Complete it with tsi_poll() or tsi_wait().
+ * @param[out] req           Request storage, valid until completed.
+ * @return   0               command sent
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int TSI_AES_Run_Async(TSI_REQ_T *req, int sid, int is_last, int data_cnt,
+		      uint32_t src_addr, uint32_t dest_addr)
+{
+	memset(req, 0, sizeof(*req));
+	req->cmd[0] = (CMD_AES_RUN << 16) | sid;
+	req->cmd[1] = (is_last << 24) | data_cnt;
+	req->cmd[2] = src_addr;
+	req->cmd[3] = dest_addr;
+	return tsi_submit(req);
 }
 
 
@@ -508,12 +754,29 @@ int TSI_SHA_Start(int sid, int inswap, int outswap, int mode_sel, int hmac,
 int TSI_SHA_Update(int sid, int data_cnt, uint32_t src_addr)
 {
 	TSI_REQ_T req;
+	int ret;
 
-	memset(&req, 0, sizeof(req));
-	req.cmd[0] = (CMD_SHA_UPDATE << 16) | sid;
-	req.cmd[1] = data_cnt;
-	req.cmd[2] = src_addr;
-	return tsi_send_command_and_wait(&req, CMD_TIME_OUT_2S);
+	ret = TSI_SHA_Update_Async(&req, sid, data_cnt, src_addr);
+	if (ret != 0)
+		return ret;
+	return tsi_wait(&req, CMD_TIME_OUT_2S);
+}
+
+/*
+ * @brief    Same as TSI_SHA_Update(), but return once the command is sent.
+ *           Complete it with tsi_poll() or tsi_wait().
+ * @param[out] req           Request storage, valid until completed.
+ * @return   0               command sent
+ * @return   otherwise       Refer to ST_XXX error code.
+ */
+int TSI_SHA_Update_Async(TSI_REQ_T *req, int sid, int data_cnt,
+			 uint32_t src_addr)
+{
+	memset(req, 0, sizeof(*req));
+	req->cmd[0] = (CMD_SHA_UPDATE << 16) | sid;
+	req->cmd[1] = data_cnt;
+	req->cmd[2] = src_addr;
+	return tsi_submit(req);
 }
 
 
@@ -725,7 +988,7 @@ int TSI_run_sha(int inswap, int outswap, int mode_sel, int hmac,
 	int sid, ret;
 
 	inv_dcache_range((uintptr_t)src_addr, data_cnt);
-	inv_dcache_range((uintptr_t)dest_addr, 32);
+	inv_dcache_range((uintptr_t)dest_addr, wcnt * 4);
 	ret = TSI_Open_Session(C_CODE_SHA, &sid);
 	if (ret != 0)
 		goto err_out;
@@ -737,7 +1000,7 @@ int TSI_run_sha(int inswap, int outswap, int mode_sel, int hmac,
 	if (ret != 0)
 		goto err_out;
 	TSI_Close_Session(C_CODE_SHA, sid);
-	inv_dcache_range((uintptr_t)dest_addr, 32);
+	inv_dcache_range((uintptr_t)dest_addr, wcnt * 4);
 	return 0;
 
 err_out:
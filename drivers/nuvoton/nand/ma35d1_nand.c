@@ -28,12 +28,23 @@ struct ma35d1_nand_info {
 	int page_size;
 	int oob_size;
 	int max_bit_corr;
+	int cache_read;	/* device supports READ CACHE (0x31/0x3F) */
 	long size;	/* nand total size */
 	long offset;	/* image offset in nand */
 };
 
 struct ma35d1_nand_info ma35d1_nand;
 
+/*
+ * Bad block table, filled in lazily: a block's markers are read from the
+ * OOB the first time the block is used and the result is kept for the rest
+ * of the boot. Blocks beyond NAND_BBT_MAX_BLOCKS are checked on every use.
+ */
+#define NAND_BBT_MAX_BLOCKS	4096U
+
+static uint32_t nand_bbt_scanned[NAND_BBT_MAX_BLOCKS / 32U];
+static uint32_t nand_bbt_bad[NAND_BBT_MAX_BLOCKS / 32U];
+
 
 /*--------------------------------------------------*/
 // define the total padding bytes for 512/1024 data segment
@@ -234,37 +245,23 @@ static void ma35d1_correct_data(unsigned char ucFieidIndex, unsigned char ucErro
 }
 
 
-static int ma35d1_nand_read_page(struct ma35d1_nand_info *nand, unsigned int page, uintptr_t buffer)
+/*
+ * DMA the page held in the NAND data/cache register to buffer and correct
+ * it with BCH as each field completes. The OOB of the page must already be
+ * in the redundant area registers when ECC is enabled.
+ */
+static int ma35d1_nand_dma_page(struct ma35d1_nand_info *nand, uintptr_t buffer)
 {
 	unsigned int volatile uStatus, uErrorCnt;
 	unsigned int volatile uF1_status;
 	unsigned char volatile i, j, uLoop;
 
-	//INFO(">%s page %i buffer %lx\n", __func__, page, buffer);
-
-	if (nand->max_bit_corr != 0)    /* ECC_EN */
-		ma35d1_nand_read_oob(nand, page);
-
 	mmio_write_32(REG_NANDCTL, mmio_read_32(REG_NANDCTL) & ~REDUN_REN);
 	/* enable DMAC */
 	mmio_write_32(REG_FMI_DMACTL, 0x1); /* enable DMAC */
 
 	/* Set DMA Transfer Starting Address */
 	mmio_write_32(REG_FMI_DMASA, buffer);
-	mmio_write_32(REG_NANDCMD, NAND_CMD_READ_1ST);       // READ 1st cycle command
-	mmio_write_32(REG_NANDADDR, 0);
-	mmio_write_32(REG_NANDADDR, 0);
-	mmio_write_32(REG_NANDADDR, page & 0xff);
-	if (nand->size > SZ_128M) {
-		mmio_write_32(REG_NANDADDR, (page >> 8) & 0xff);
-		mmio_write_32(REG_NANDADDR, ((page >> 16) & 0xff) | NAND_EOA);
-	} else {
-		mmio_write_32(REG_NANDADDR, ((page >> 8) & 0xff) | NAND_EOA);
-	}
-
-	mmio_write_32(REG_NANDCMD, NAND_CMD_READ_2ND);       // READ 2nd cycle command
-
-	ma35d1_nand_wait_ready(1);
 
 	uF1_status = 0;
 	uStatus = 0;
@@ -339,8 +336,104 @@ static int ma35d1_nand_read_page(struct ma35d1_nand_info *nand, unsigned int pag
 	return 0;
 }
 
+static void ma35d1_nand_write_page_addr(struct ma35d1_nand_info *nand, unsigned int page)
+{
+	mmio_write_32(REG_NANDADDR, 0);
+	mmio_write_32(REG_NANDADDR, 0);
+	mmio_write_32(REG_NANDADDR, page & 0xff);
+	if (nand->size > SZ_128M) {
+		mmio_write_32(REG_NANDADDR, (page >> 8) & 0xff);
+		mmio_write_32(REG_NANDADDR, ((page >> 16) & 0xff) | NAND_EOA);
+	} else {
+		mmio_write_32(REG_NANDADDR, ((page >> 8) & 0xff) | NAND_EOA);
+	}
+}
+
+static int ma35d1_nand_read_page(struct ma35d1_nand_info *nand, unsigned int page, uintptr_t buffer)
+{
+	//INFO(">%s page %i buffer %lx\n", __func__, page, buffer);
+
+	if (nand->max_bit_corr != 0)    /* ECC_EN */
+		ma35d1_nand_read_oob(nand, page);
+
+	mmio_write_32(REG_NANDCMD, NAND_CMD_READ_1ST);       // READ 1st cycle command
+	ma35d1_nand_write_page_addr(nand, page);
+	mmio_write_32(REG_NANDCMD, NAND_CMD_READ_2ND);       // READ 2nd cycle command
+
+	ma35d1_nand_wait_ready(1);
+
+	return ma35d1_nand_dma_page(nand, buffer);
+}
+
+/* Move the data output of the cache register to column */
+static void ma35d1_nand_change_column(unsigned int column)
+{
+	mmio_write_32(REG_NANDCMD, NAND_CMD_RNDOUT);
+	mmio_write_32(REG_NANDADDR, column & 0xff);
+	mmio_write_32(REG_NANDADDR, ((column >> 8) & 0xff) | NAND_EOA);
+	mmio_write_32(REG_NANDCMD, NAND_CMD_RNDOUT_START);
+
+	/* delay for NAND flash tWHR/tCCS time */
+	udelay(1);
+}
+
+/* Copy the OOB of the page in the cache register to the redundant area */
+static void ma35d1_nand_read_cache_oob(struct ma35d1_nand_info *nand)
+{
+	int volatile i;
+	unsigned char *ptr;
+
+	ma35d1_nand_change_column(nand->page_size);
+
+	ptr = (unsigned char *)REG_NANDRA0;
+	for (i=0; i<nand->oob_size; i++)
+		*(unsigned char*) ptr++ = mmio_read_8(REG_NANDDATA);
+
+	ma35d1_nand_change_column(0);
+}
+
+/*
+ * Stream consecutive pages of one block with READ CACHE SEQUENTIAL. Each
+ * 0x31 moves the current page into the cache register and starts loading
+ * the next one into the data register, so the array read of page N+1
+ * overlaps the DMA and BCH correction of page N. The last page is moved
+ * with READ CACHE END (0x3F), which does not start another array read.
+ */
+static int ma35d1_nand_read_pages_cache(struct ma35d1_nand_info *nand, uintptr_t buf, int page_start, int page_count)
+{
+	mmio_write_32(REG_NANDINTSTS, 0x400);   /* RB0_IF */
+	mmio_write_32(REG_NANDCMD, NAND_CMD_READ_1ST);
+	ma35d1_nand_write_page_addr(nand, page_start);
+	mmio_write_32(REG_NANDCMD, NAND_CMD_READ_2ND);
+	ma35d1_nand_wait_ready(1);
+
+	while (page_count > 0)
+	{
+		mmio_write_32(REG_NANDINTSTS, 0x400);   /* RB0_IF */
+		if (page_count > 1)
+			mmio_write_32(REG_NANDCMD, NAND_CMD_READ_CACHE_SEQ);
+		else
+			mmio_write_32(REG_NANDCMD, NAND_CMD_READ_CACHE_END);
+		ma35d1_nand_wait_ready(1);
+
+		if (nand->max_bit_corr != 0)    /* ECC_EN */
+			ma35d1_nand_read_cache_oob(nand);
+
+		if (ma35d1_nand_dma_page(nand, buf)) {
+			ma35d1_nand_reset();
+			return -EBADMSG;
+		}
+		buf += nand->page_size;
+		page_count--;
+	}
+	return 0;
+}
+
 static int ma35d1_nand_read_pages(struct ma35d1_nand_info *nand, uintptr_t buf, int page_start, int page_count)
 {
+	if (nand->cache_read && (page_count > 1))
+		return ma35d1_nand_read_pages_cache(nand, buf, page_start, page_count);
+
 	while (page_count > 0)
 	{
 		if (ma35d1_nand_read_page(nand, page_start, buf)) {
@@ -384,6 +477,23 @@ static int ma35d1_block_isbad(struct ma35d1_nand_info *nand, unsigned int pba)
 	return 0;   /* good block */
 }
 
+static int ma35d1_bbt_isbad(struct ma35d1_nand_info *nand, unsigned int pba)
+{
+	unsigned int idx = pba / 32U;
+	uint32_t mask = BIT_32(pba % 32U);
+
+	if (pba >= NAND_BBT_MAX_BLOCKS)
+		return ma35d1_block_isbad(nand, pba);
+
+	if ((nand_bbt_scanned[idx] & mask) == 0U) {
+		if (ma35d1_block_isbad(nand, pba))
+			nand_bbt_bad[idx] |= mask;
+		nand_bbt_scanned[idx] |= mask;
+	}
+
+	return (nand_bbt_bad[idx] & mask) != 0U;
+}
+
 
 static size_t parse_nand_read(struct ma35d1_nand_info *nand, int lba, uintptr_t buf, size_t size)
 {
@@ -397,7 +507,7 @@ static size_t parse_nand_read(struct ma35d1_nand_info *nand, int lba, uintptr_t
 	int page_count, ret;
 
 	while (pages_to_read) {
-		ret = ma35d1_block_isbad(nand, block);
+		ret = ma35d1_bbt_isbad(nand, block);
 		if (ret) {
 			block++;
 			if ((--block_count) <= 0)
@@ -474,6 +584,7 @@ static void ma35d1_nand_setup(struct ma35d1_nand_info *nand)
 	count = fdt_read_uint32_default(fdt, node, "nand-block-count", 256) / 1024;
 	nand->size = (nand->page_size / 1024) * nand->pages_per_block * count;
 	nand->offset = fdt_read_uint32_default(fdt, node, "nand-image-offset", 0);
+	nand->cache_read = (fdt_getprop(fdt, node, "nand-cache-read", NULL) != NULL);
 
 	INFO("NAND: Size %liMB, Page %i, pages per block %i, oob size %i, bit correct %i\n", nand->size, nand->page_size, 
 		nand->pages_per_block, nand->oob_size, nand->max_bit_corr);
@@ -586,6 +697,7 @@ static struct io_block_dev_spec nand_dev_spec = {
 		.read = ma35d1_nand_read,
 	},
 	/* fill .block_size at run-time */
+	.flags = IO_BLOCK_FLAG_DIRECT_READ,
 };
 
 int ma35d1_nand_init(struct io_block_dev_spec **block_dev_spec, long *offset)
@@ -593,6 +705,10 @@ int ma35d1_nand_init(struct io_block_dev_spec **block_dev_spec, long *offset)
 	ma35d1_nand_setup(&ma35d1_nand);
 	*offset = ma35d1_nand.offset;
 
+	/* start from an empty bad block table */
+	memset(nand_bbt_scanned, 0, sizeof(nand_bbt_scanned));
+	memset(nand_bbt_bad, 0, sizeof(nand_bbt_bad));
+
 	nand_dev_spec.block_size = ma35d1_nand.page_size;
 
 	*block_dev_spec = &nand_dev_spec;
@@ -47,228 +47,250 @@
 
 
 /*---------------------------------------------------------------------------*/
-/* Global variables                                                          */
+/* I2C0 engine                                                               */
 /*---------------------------------------------------------------------------*/
-unsigned char g_u8DeviceAddr = DEVICE_ADDR;
-unsigned char g_uPageNum;
-unsigned char g_u8RegAddr;
-unsigned char g_u8WriteData;
+/* I2C0 input clock, set by the clock setup before the first PMIC access */
+unsigned long pmic_clk;
 
-volatile unsigned char g_u8RxData;
-volatile unsigned char g_u8DataLen;
-volatile unsigned char g_u8EndFlag = 0;
+/* Last voltage set on each rail, indexed by VOL_xxx type */
+#define PMIC_TYPES		6
 
-void I2C_MasterRx(unsigned int u32Status)
+static int pmic_state[PMIC_TYPES] = {
+	0, VOL_1_20 /*CPU*/, VOL_3_30 /*SD*/
+};
+#if (MA35D1_PMIC != PMIC_NO)
+static int pmicIsInit;
+#endif
+
+/* SCL frequency, in kHz */
+#define I2C_SPEED_KHZ		400U
+
+/*
+ * Upper bound on SI polls for one transaction. The PMIC is first used in
+ * BL2 before the delay timer is set up, so this is a loop count, not a time.
+ */
+#define I2C_POLL_MAX		0x200000U
+
+/* I2C0 status codes */
+#define I2C_ST_START		0x08U
+#define I2C_ST_RESTART		0x10U
+#define I2C_ST_SLAW_ACK		0x18U
+#define I2C_ST_DATA_ACK		0x28U
+#define I2C_ST_ARB_LOST		0x38U
+#define I2C_ST_SLAR_ACK		0x40U
+#define I2C_ST_RDATA_NACK	0x58U
+
+/*
+ * One bus transaction. A write transaction sends every entry of 'msg' as
+ * <reg, val>, joined by repeated STARTs and closed by a single STOP. A read
+ * transaction sends msg[0].reg and reads one byte back into 'rx'.
+ */
+static struct {
+	const pmic_reg_t *msg;
+	unsigned int num;
+	unsigned int idx;
+	int read;
+	int data_phase;		/* Write: register address sent. Read: SLA+R */
+	uint8_t rx;
+	int result;		/* 0: running, 1: done, -1: failed */
+} xfer;
+
+static void i2c_ctl(uint32_t bits)
 {
-	if (u32Status == 0x08) {
-		/* START has been transmitted and prepare SLA+W */
-		mmio_write_32(REG_I2C0_DAT,
-					g_u8DeviceAddr|(g_uPageNum << 1));
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | I2C_CTL_SI);
-	} else if (u32Status == 0x18) {
-		/* SLA+W has been transmitted and ACK has been received */
-		mmio_write_32(REG_I2C0_DAT, g_u8RegAddr);
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | I2C_CTL_SI);
-	} else if (u32Status == 0x20) {
-		/* SLA+W has been transmitted and NACK has been received */
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | (I2C_CTL_STA |
-					I2C_CTL_STO | I2C_CTL_SI));
-	} else if (u32Status == 0x28) {
-		/* DATA has been transmitted and ACK has been received */
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | (I2C_CTL_STA |
-					I2C_CTL_SI)); // repeat start
-	} else if (u32Status == 0x10) {
-		/* Repeat START has been transmitted and prepare SLA+R */
-		mmio_write_32(REG_I2C0_DAT,
-					(g_u8DeviceAddr|(g_uPageNum << 1)) |
-					0x01);
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | I2C_CTL_SI);
-	} else if (u32Status == 0x40) {
-		/* SLA+R has been transmitted and ACK has been received */
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | I2C_CTL_SI);
-	} else if (u32Status == 0x58) {
-		/* DATA has been received and NACK has been returned */
-		g_u8RxData = mmio_read_32(REG_I2C0_DAT);
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | (I2C_CTL_STO | I2C_CTL_SI));
-		g_u8EndFlag = 1;
-	} else {
-		//ERROR("Status 0x%x is NOT processed\n", u32Status);
-	}
+	mmio_write_32(REG_I2C0_CTL,
+		      (mmio_read_32(REG_I2C0_CTL) & ~I2C_CTL_ALL) | bits);
 }
 
-void I2C_MasterTx(unsigned int u32Status)
+/* Advance the transaction on one SI event */
+static void i2c_step(uint32_t status)
 {
-	if (u32Status == 0x08) {
-		/* START has been transmitted */
-		 /* Write SLA+W to Register I2CDAT */
-		mmio_write_32(REG_I2C0_DAT,
-					g_u8DeviceAddr|(g_uPageNum << 1));
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | I2C_CTL_SI);
-	} else if (u32Status == 0x18) {
-		/* SLA+W has been transmitted and ACK has been received */
-		mmio_write_32(REG_I2C0_DAT, g_u8RegAddr);
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | I2C_CTL_SI);
-	} else if (u32Status == 0x20) {
-		/* SLA+W has been transmitted and NACK has been received */
-		mmio_write_32(REG_I2C0_CTL,
-					(mmio_read_32(REG_I2C0_CTL) &
-					~0x3c) | (I2C_CTL_STA | I2C_CTL_STO |
-					I2C_CTL_SI));
-	} else if (u32Status == 0x28) {
-		/* DATA has been transmitted and ACK has been received */
-		if ((g_u8DataLen == 0) && (g_u8EndFlag == 0)) {
-			mmio_write_32(REG_I2C0_DAT, g_u8WriteData);
-			mmio_write_32(REG_I2C0_CTL,
-						(mmio_read_32(REG_I2C0_CTL) &
-						~0x3c) | I2C_CTL_SI);
-			g_u8DataLen++;
+	switch (status) {
+	case I2C_ST_START:
+	case I2C_ST_RESTART:
+		if (xfer.read && xfer.data_phase)
+			mmio_write_32(REG_I2C0_DAT, DEVICE_ADDR | 0x01);
+		else
+			mmio_write_32(REG_I2C0_DAT, DEVICE_ADDR);
+		i2c_ctl(I2C_CTL_SI);
+		break;
+	case I2C_ST_SLAW_ACK:
+		mmio_write_32(REG_I2C0_DAT, xfer.msg[xfer.idx].reg);
+		xfer.data_phase = 0;
+		i2c_ctl(I2C_CTL_SI);
+		break;
+	case I2C_ST_DATA_ACK:
+		if (xfer.read) {
+			/* Register address sent, turn the bus around */
+			xfer.data_phase = 1;
+			i2c_ctl(I2C_CTL_STA | I2C_CTL_SI);
+		} else if (!xfer.data_phase) {
+			mmio_write_32(REG_I2C0_DAT, xfer.msg[xfer.idx].val);
+			xfer.data_phase = 1;
+			i2c_ctl(I2C_CTL_SI);
+		} else if (++xfer.idx < xfer.num) {
+			i2c_ctl(I2C_CTL_STA | I2C_CTL_SI);
 		} else {
-			g_u8DataLen = 0;
-			mmio_write_32(REG_I2C0_CTL,
-						(mmio_read_32(REG_I2C0_CTL) &
-						~0x3c) |
-						(I2C_CTL_STO | I2C_CTL_SI));
-			g_u8EndFlag = 1;
+			i2c_ctl(I2C_CTL_STO | I2C_CTL_SI);
+			xfer.result = 1;
 		}
-	} else {
-		//ERROR("Status 0x%x is NOT processed\n", u32Status);
+		break;
+	case I2C_ST_SLAR_ACK:
+		/* AA clear: the single data byte is NACKed */
+		i2c_ctl(I2C_CTL_SI);
+		break;
+	case I2C_ST_RDATA_NACK:
+		xfer.rx = mmio_read_32(REG_I2C0_DAT);
+		i2c_ctl(I2C_CTL_STO | I2C_CTL_SI);
+		xfer.result = 1;
+		break;
+	case I2C_ST_ARB_LOST:
+		i2c_ctl(I2C_CTL_SI);
+		xfer.result = -1;
+		break;
+	default:
+		/* NACK or bus error */
+		i2c_ctl(I2C_CTL_STO | I2C_CTL_SI);
+		xfer.result = -1;
+		break;
 	}
 }
 
-unsigned int ma35d1_write_i2c_data(unsigned int u32Addr, unsigned int u32Data)
+static int i2c_run(const pmic_reg_t *msg, unsigned int num, int read)
 {
-	unsigned int I2C_TIME_OUT_COUNT = 0x200000;
-	unsigned int u32Status;
-	unsigned int u32time_out = 0;
+	unsigned int poll = 0;
 
-	g_uPageNum = 0;
-	if (g_uPageNum == 0xff) {
-		ERROR("\n address error !!\n");
-		return 0;
-	}
+	xfer.msg = msg;
+	xfer.num = num;
+	xfer.idx = 0;
+	xfer.read = read;
+	xfer.data_phase = 0;
+	xfer.result = 0;
 
-	g_u8RegAddr     = u32Addr;
-	g_u8WriteData   = u32Data;
-	g_u8EndFlag     = 0x0;
+	i2c_ctl(I2C_CTL_STA);
 
-	mmio_write_32(REG_I2C0_CTL, (mmio_read_32(REG_I2C0_CTL) &
-				~0x3c) | I2C_CTL_STA);
-
-	while (1) {
-		if (mmio_read_32(REG_I2C0_CTL) & I2C_CTL_SI) {
-			u32Status = mmio_read_32(REG_I2C0_STATUS);
-			I2C_MasterTx(u32Status);
-		}
-
-		if (g_u8EndFlag) {
+	while (xfer.result == 0) {
+		if ((mmio_read_32(REG_I2C0_CTL) & I2C_CTL_SI) != 0U)
+			i2c_step(mmio_read_32(REG_I2C0_STATUS));
+		else if (++poll > I2C_POLL_MAX)
 			break;
-		}
-		u32time_out++;
-		if (u32time_out > I2C_TIME_OUT_COUNT) {
-			return 0; // error
-		}
 	}
-	return 1;
+
+	if (xfer.result <= 0) {
+		/* Release the bus before a retry */
+		i2c_ctl(I2C_CTL_STO | I2C_CTL_SI);
+		return -EIO;
+	}
+	return 0;
 }
 
-unsigned int ma35d1_read_i2c_data(unsigned int u32Addr, unsigned int *u32Data)
+/*---------------------------------------------------------------------------*/
+/* Register shadow                                                           */
+/*---------------------------------------------------------------------------*/
+/*
+ * Write-through copy of the PMIC registers read or written here. Firmware
+ * is the only master on I2C0, so a cached register stays valid until it is
+ * written again: reads come from the shadow, and writes of the value
+ * already held never reach the bus.
+ */
+#define PMIC_BATCH_MAX		8
+
+static uint8_t pmic_shadow[256];
+static uint32_t pmic_shadow_valid[256 / 32];
+
+static int shadow_valid(unsigned int reg)
 {
-	unsigned int I2C_TIME_OUT_COUNT = 0x200000;
-	unsigned int u32Status;
-	unsigned int u32time_out = 0;
+	return (pmic_shadow_valid[reg / 32] >> (reg % 32)) & 1U;
+}
 
-	g_uPageNum = 0;
-	if (g_uPageNum == 0xff) {
-		ERROR("\n address error !!\n");
-		return 0;
-	}
+static void shadow_update(unsigned int reg, unsigned int val)
+{
+	pmic_shadow[reg] = val;
+	pmic_shadow_valid[reg / 32] |= 1U << (reg % 32);
+}
 
-	g_u8RegAddr     = u32Addr;
-	g_u8EndFlag     = 0x0;
+static void shadow_invalidate(unsigned int reg)
+{
+	pmic_shadow_valid[reg / 32] &= ~(1U << (reg % 32));
+}
 
-	mmio_write_32(REG_I2C0_CTL, (mmio_read_32(REG_I2C0_CTL) &
-				 ~0x3c) | I2C_CTL_STA);
+/*
+ * Write a batch of PMIC registers in one bus transaction, leaving out the
+ * ones that already hold their value. Returns 0, or -EIO if the PMIC did
+ * not take it after RETRY_COUNT attempts.
+ */
+int ma35d1_pmic_write_regs(const pmic_reg_t *regs, unsigned int num)
+{
+	pmic_reg_t msg[PMIC_BATCH_MAX];
+	unsigned int i, n = 0;
+	int j;
 
-	while (1) {
-		if (mmio_read_32(REG_I2C0_CTL) & I2C_CTL_SI) {
-			u32Status = mmio_read_32(REG_I2C0_STATUS);
-			I2C_MasterRx(u32Status);
-		}
+	assert(num <= PMIC_BATCH_MAX);
 
-		if (g_u8EndFlag) {
-			break;
-		}
+	for (i = 0; i < num; i++) {
+		if (shadow_valid(regs[i].reg) &&
+		    (pmic_shadow[regs[i].reg] == regs[i].val))
+			continue;
+		msg[n++] = regs[i];
+	}
+	if (n == 0U)
+		return 0;
 
-		u32time_out++;
-		if (u32time_out > I2C_TIME_OUT_COUNT) {
-			return 1; // error
+	for (j = 0; j < RETRY_COUNT; j++) {
+		if (i2c_run(msg, n, 0) == 0) {
+			for (i = 0; i < n; i++)
+				shadow_update(msg[i].reg, msg[i].val);
+			return 0;
 		}
 	}
 
-	*u32Data = g_u8RxData;
-	return 2;
+	/* Part of the batch may have landed */
+	for (i = 0; i < n; i++)
+		shadow_invalidate(msg[i].reg);
+	return -EIO;
 }
 
 unsigned int ma35d1_read_pmic_data(
 	unsigned int u32Addr,
 	unsigned int *u32Data)
 {
-	int j = RETRY_COUNT;
+	pmic_reg_t msg = { .reg = u32Addr };
+	int j;
 
-	while (j-- > 0) {
-		if (ma35d1_read_i2c_data(u32Addr, u32Data) == 2) {
-			break;
-		}
+	if (shadow_valid(msg.reg)) {
+		*u32Data = pmic_shadow[msg.reg];
+		return 1;
 	}
 
-	if (j <= 0) {
-		//WARN("\nREAD PMIC DATA ERROR!\n");
-		return 0;
+	for (j = 0; j < RETRY_COUNT; j++) {
+		if (i2c_run(&msg, 1, 1) == 0) {
+			shadow_update(msg.reg, xfer.rx);
+			*u32Data = xfer.rx;
+			return 1;
+		}
 	}
-
-	return 1;
+	return 0;
 }
 
-unsigned int ma35d1_write_pmic_data(unsigned int u32Addr, unsigned int u32Data)
+/* Load 'regs' into the shadow, so later writes can be compared */
+static void __unused pmic_shadow_fill(const unsigned char *regs,
+				      unsigned int num)
 {
-	int j = RETRY_COUNT;
+	unsigned int i, val;
 
-	while (j-- > 0) {
-		if (ma35d1_write_i2c_data(u32Addr, u32Data) == 1) {
-			break;
-		}
-	}
+	for (i = 0; i < num; i++)
+		ma35d1_read_pmic_data(regs[i], &val);
+}
 
-	if (j <= 0) {
-		/* WARN("\nWRITE PMIC DATA ERROR [%d]!\n", j); */
-		return 0;
-	}
+unsigned int ma35d1_write_pmic_data(unsigned int u32Addr, unsigned int u32Data)
+{
+	pmic_reg_t msg = { .reg = u32Addr, .val = u32Data };
 
-	return 1;
+	return (ma35d1_pmic_write_regs(&msg, 1) == 0) ? 1 : 0;
 }
 
 void ma35d1_i2c0_init(unsigned int sys_clk)
 {
-	unsigned long clk_rate;
-	unsigned int u32Div, speed;
+	unsigned int u32Div;
 
 	mmio_write_32(0X40460208, mmio_read_32(0X40460208) |
 		    (0x3fff << 16)); // enable GPIO clock
@@ -281,18 +303,14 @@ void ma35d1_i2c0_init(unsigned int sys_clk)
 		    (0x6<<28))); // PD.7 I2C0_CLK
 	mmio_write_32(0x400400F0, 0x5 << 12); // pull high
 
-	/* i2c_clk = 100KHz */
-	clk_rate = sys_clk;
-	speed = 100*1000;
-
-	/* assume speed above 1000 are Hz-specified */
-	if (speed > 1000)
-		speed = speed / 1000;
-	if (speed > 400)
-		speed = 400;
-
-	u32Div = (unsigned int)(((clk_rate * 10U) /
-			(speed * 4U) + 5U) / 10U - 1U);
+	/* i2c_clk = 400KHz, SCL = sys_clk / (4 * (DIV + 1)) */
+	if (sys_clk == 0U) {
+		WARN("PMIC: I2C0 clock unknown, using a slow SCL\n");
+		u32Div = 0xFF;
+	} else {
+		u32Div = (sys_clk + (I2C_SPEED_KHZ * 4000U) - 1U) /
+			 (I2C_SPEED_KHZ * 4000U) - 1U;
+	}
 
 	mmio_write_32(REG_I2C0_CLKDIV, u32Div);
 	mmio_write_32(REG_I2C0_CTL, mmio_read_32(REG_I2C0_CTL)  |
@@ -305,18 +323,73 @@ void ma35d1_i2c0_init(unsigned int sys_clk)
 #define VOL_LDO5 0x04
 #define VOL_LDO6 0x05
 
+/* LDO enable register */
+#define IP6103_LDO_EN 0x41
+
+/*
+ * Set LDO 'ldo' (voltage register 'reg', enable bit 'en'). The voltage and
+ * the enable bit go out in one I2C transaction.
+ */
+static int ip6103_set_ldo(int ldo, unsigned int reg, unsigned int en, int vol)
+{
+	pmic_reg_t regs[2];
+	unsigned int temp = 0;
+	unsigned int code;
+
+	switch (vol)
+	{
+	case VOL_1_00:
+		code = 0x0C;
+		break;
+	case VOL_1_20:
+		code = 0x14;
+		break;
+	case VOL_1_80:
+		code = 0x2c;
+		break;
+	case VOL_2_50:
+		code = 0x48;
+		break;
+	case VOL_3_30:
+		code = 0x68;
+		break;
+	default:
+		ma35d1_read_pmic_data(IP6103_LDO_EN, &temp);
+		ma35d1_write_pmic_data(IP6103_LDO_EN, temp & ~en);
+		ERROR("Not support voltage!\n");
+		return -1;
+	}
+
+	INFO("IP6103 LDO%d %d.%02dV\n", ldo, vol / 100, vol % 100);
+	if (ma35d1_read_pmic_data(IP6103_LDO_EN, &temp) == 0)
+		return 0;
+	regs[0].reg = reg;
+	regs[0].val = code;
+	regs[1].reg = IP6103_LDO_EN;
+	regs[1].val = temp | en;
+	return (ma35d1_pmic_write_regs(regs, 2) == 0) ? 1 : 0;
+}
+
 int ma35d1_set_pmic(int type, int vol)
 {
+	static const pmic_reg_t init_regs[] = {
+		{ 0x2e, 0x00 },
+		{ 0x35, 0x00 },
+	};
+	static const unsigned char shadow_regs[] = {
+		0x21, 0x2e, 0x35, IP6103_LDO_EN, 0x42, 0x4C, 0x4E
+	};
 	unsigned int reg0 = 0xff;
-	unsigned int reg1 = 0x41;
-	unsigned int temp = 0;
 	int ret = 0;
 
+	if ((type < 0) || (type >= PMIC_TYPES))
+		return -1;
+
 	if (pmicIsInit == 0) {
 		ma35d1_i2c0_init(pmic_clk);
 		pmicIsInit = 1;
-		ma35d1_write_pmic_data(0x2e, 0x00);
-		ma35d1_write_pmic_data(0x35, 0x00);
+		pmic_shadow_fill(shadow_regs, ARRAY_SIZE(shadow_regs));
+		ma35d1_pmic_write_regs(init_regs, ARRAY_SIZE(init_regs));
 	}
 
 	if (type == VOL_CPU) {
@@ -416,82 +489,14 @@ int ma35d1_set_pmic(int type, int vol)
 			break;
 		}
 	} else if (type == VOL_LDO5) {
-		reg0 = 0x4C;
-		ma35d1_read_pmic_data(reg1, &temp);
-		switch (vol)
-		{
-		case VOL_1_00:
-			INFO("IP6103 LDO5 1.00V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x0C);
-			ma35d1_write_pmic_data(reg1,temp|0x20);
-			break;
-		case VOL_1_20:
-			INFO("IP6103 LDO5 1.20V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x14);
-			ma35d1_write_pmic_data(reg1,temp|0x20);
-			break;
-		case VOL_1_80:
-			INFO("IP6103 LDO5 1.80V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x2c);
-			ma35d1_write_pmic_data(reg1,temp|0x20);
-			break;
-		case VOL_2_50:
-			INFO("IP6103 LDO5 2.50V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x48);
-			ma35d1_write_pmic_data(reg1,temp|0x20);
-			break;
-		case VOL_3_30:
-			INFO("IP6103 LDO5 3.30V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x68);
-			ma35d1_write_pmic_data(reg1,temp|0x20);
-			break;
-		default:
-			ma35d1_write_pmic_data(reg1,temp&~0x20);
-			ERROR("Not support voltage!\n");
-			ret=-1;
-			break;
-		}
+		ret = ip6103_set_ldo(5, 0x4C, 0x20, vol);
 	} else if (type == VOL_LDO6) {
-		reg0 = 0x4E;
-		ma35d1_read_pmic_data(reg1, &temp);
-		switch (vol)
-		{
-		case VOL_1_00:
-			INFO("IP6103 LDO6 1.00V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x0C);
-			ma35d1_write_pmic_data(reg1,temp|0x40);
-			break;
-		case VOL_1_20:
-			INFO("IP6103 LDO6 1.20V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x14);
-			ma35d1_write_pmic_data(reg1,temp|0x40);
-			break;
-		case VOL_1_80:
-			INFO("IP6103 LDO6 1.80V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x2c);
-			ma35d1_write_pmic_data(reg1,temp|0x40);
-			break;
-		case VOL_2_50:
-			INFO("IP6103 LDO6 2.50V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x48);
-			ma35d1_write_pmic_data(reg1,temp|0x40);
-			break;
-		case VOL_3_30:
-			INFO("IP6103 LDO6 3.30V\n");
-			ret = ma35d1_write_pmic_data(reg0, 0x68);
-			ma35d1_write_pmic_data(reg1,temp|0x40);
-			break;
-		default:
-			ma35d1_write_pmic_data(reg1,temp&~0x40);
-			ERROR("Not support voltage!\n");
-			ret=-1;
-			break;
-		}
+		ret = ip6103_set_ldo(6, 0x4E, 0x40, vol);
 	} else {
 		ERROR("Not support type!\n");
 	}
 
-	if (ret >= 0)
+	if (ret > 0)
 		pmic_state[type] = vol;
 
 	return ret;
@@ -500,11 +505,16 @@ int ma35d1_set_pmic(int type, int vol)
 int ma35d1_set_pmic(int type, int vol)
 {
 	unsigned int reg = 0xff;
+	static const unsigned char shadow_regs[] = { 0x32, 0xA4 };
 	int ret = 0;
 
+	if ((type < 0) || (type >= PMIC_TYPES))
+		return -1;
+
 	if (pmicIsInit == 0) {
 		ma35d1_i2c0_init(pmic_clk);
 		pmicIsInit = 1;
+		pmic_shadow_fill(shadow_regs, ARRAY_SIZE(shadow_regs));
 	}
 
 	if (type == VOL_CPU) {
@@ -580,7 +590,7 @@ int ma35d1_set_pmic(int type, int vol)
 		ERROR("Not support type!\n");
 	}
 
-	if (ret >= 0)
+	if (ret > 0)
 		pmic_state[type] = vol;
 
 	return ret;
@@ -589,11 +599,16 @@ int ma35d1_set_pmic(int type, int vol)
 int ma35d1_set_pmic(int type, int vol)
 {
 	unsigned int reg = 0x07;
+	static const unsigned char shadow_regs[] = { 0x07 };
 	int ret = 0;
 
+	if ((type < 0) || (type >= PMIC_TYPES))
+		return -1;
+
 	if (pmicIsInit == 0) {
 		ma35d1_i2c0_init(pmic_clk);
 		pmicIsInit = 1;
+		pmic_shadow_fill(shadow_regs, ARRAY_SIZE(shadow_regs));
 	}
 
 	switch (vol)
@@ -636,7 +651,7 @@ int ma35d1_set_pmic(int type, int vol)
 		break;
 	}
 
-	if (ret >= 0)
+	if (ret > 0)
 		pmic_state[type] = vol;
 
 	return ret;
@@ -649,6 +664,8 @@ int ma35d1_set_pmic(int type, int vol) {
 
 int ma35d1_get_pmic(int type)
 {
+	if ((type < 0) || (type >= PMIC_TYPES))
+		return 0;
 	return pmic_state[type];
 }
 
@@ -36,10 +36,28 @@ struct ma35d1_qspi_info {
 	unsigned char   dummybyte1;     /* between command and address */
 	unsigned char   dummybyte2;     /* between address and data */
 	unsigned char   SuspendInterval;
+	unsigned char   seq_read;	/* SPINAND_SEQ_READ_* */
+	unsigned char   cont_dummy;	/* dummy bytes of a quad read with BUF = 0 */
+	unsigned char   pdma_tx_req;	/* PDMA request source of QSPI0_TX, 0: PIO */
+	unsigned char   pdma_rx_req;	/* PDMA request source of QSPI0_RX, 0: PIO */
+	unsigned int    ctl_quad_out;	/* QSPI0_CTL for the quad IO address phase */
+	unsigned int    ctl_quad_in;	/* QSPI0_CTL for the quad data phase */
+	unsigned int    ctl_single;	/* QSPI0_CTL after a quad read */
 };
 
 struct ma35d1_qspi_info ma35d1_qspi;
 
+/*
+ * SPI-NAND bad block table, filled in lazily: a block's markers are read
+ * from the OOB the first time the block is used and the result is kept for
+ * the rest of the boot. Blocks beyond SPINAND_BBT_MAX_BLOCKS are checked on
+ * every use.
+ */
+#define SPINAND_BBT_MAX_BLOCKS	4096U
+
+static uint32_t spinand_bbt_scanned[SPINAND_BBT_MAX_BLOCKS / 32U];
+static uint32_t spinand_bbt_bad[SPINAND_BBT_MAX_BLOCKS / 32U];
+
 #define SPINOR_BLOCK_SIZE	(2048)
 
 /***************************************************************/
@@ -68,6 +86,122 @@ static void nus3500_spi_sendcmd(unsigned char *cmd, unsigned int cmdlen, unsigne
 	mmio_write_32(REG_QSPI0_SSCTL, 0x05);   // CS0 high
 }
 
+/*
+ * Data phase: clock count words into buf. The TX FIFO is topped up to
+ * QSPI_FIFO_DEPTH words in flight and everything the RX FIFO holds is
+ * drained per status read, so the bus keeps running instead of stopping
+ * for a register round trip after every word. Keeping at most a FIFO's
+ * worth of words in flight means neither FIFO can overflow. The caller
+ * sets the data width (32-bit with byte reorder for page data).
+ */
+static void ma35d1_qspi_pio_read(unsigned int *buf, unsigned int count)
+{
+	unsigned int tx = 0, rx = 0;
+	unsigned int rxcnt;
+
+	while (rx < count)
+	{
+		while ((tx < count) && ((tx - rx) < QSPI_FIFO_DEPTH)) {
+			mmio_write_32(REG_QSPI0_TX, 0x00);
+			tx++;
+		}
+
+		rxcnt = (mmio_read_32(REG_QSPI0_STATUS) & QSPI_STATUS_RXCNT_MSK) >>
+			QSPI_STATUS_RXCNT_POS;
+		while (rxcnt--) {
+			*buf++ = mmio_read_32(REG_QSPI0_RX);
+			rx++;
+		}
+	}
+}
+
+/* dummy word fed to QSPI0_TX by the PDMA TX channel */
+static unsigned int qspi_pdma_zero;
+
+/*
+ * Data phase through PDMA0: channel 0 feeds dummy words from a fixed zero
+ * word to QSPI0_TX while channel 1 moves QSPI0_RX straight into buf, and
+ * the CPU only polls for completion. A basic mode transfer moves at most
+ * PDMA_MAX_TXCNT words, so longer reads are split. buf must be in memory
+ * the caller keeps coherent (the block readers invalidate it around the
+ * transfer).
+ *
+ * The transfer is synchronous: there is no descriptor chain and nothing
+ * overlaps it, since io_block waits for every read anyway. What it saves
+ * over PIO is the per-word FIFO polling, not the wire time.
+ */
+static int ma35d1_qspi_pdma_read(struct ma35d1_qspi_info *qspi, unsigned int *buf, unsigned int count)
+{
+	unsigned int chunk, ctl;
+	uint64_t timeout;
+	int ret = 0;
+
+	flush_dcache_range((uintptr_t)&qspi_pdma_zero, sizeof(qspi_pdma_zero));
+
+	while (count > 0)
+	{
+		chunk = MIN(count, PDMA_MAX_TXCNT);
+		ctl = ((chunk - 1) << PDMA_DSCT_CTL_TXCNT_POS) | PDMA_WIDTH_32 |
+		      PDMA_REQ_SINGLE | PDMA_OP_BASIC | PDMA_TBINTDIS;
+
+		mmio_write_32(REG_PDMA0_CHRST, PDMA_QSPI_CH_MSK);
+		mmio_write_32(REG_PDMA0_REQSEL0_3,
+			      (qspi->pdma_rx_req << (8 * PDMA_QSPI_RX_CH)) |
+			      (qspi->pdma_tx_req << (8 * PDMA_QSPI_TX_CH)));
+
+		mmio_write_32(REG_PDMA0_DSCT_SA(PDMA_QSPI_RX_CH), REG_QSPI0_RX);
+		mmio_write_32(REG_PDMA0_DSCT_DA(PDMA_QSPI_RX_CH), (uintptr_t)buf);
+		mmio_write_32(REG_PDMA0_DSCT_CTL(PDMA_QSPI_RX_CH), ctl | PDMA_SAR_FIX);
+
+		mmio_write_32(REG_PDMA0_DSCT_SA(PDMA_QSPI_TX_CH), (uintptr_t)&qspi_pdma_zero);
+		mmio_write_32(REG_PDMA0_DSCT_DA(PDMA_QSPI_TX_CH), REG_QSPI0_TX);
+		mmio_write_32(REG_PDMA0_DSCT_CTL(PDMA_QSPI_TX_CH), ctl | PDMA_SAR_FIX | PDMA_DAR_FIX);
+
+		mmio_write_32(REG_PDMA0_TDSTS, PDMA_QSPI_CH_MSK);
+		mmio_write_32(REG_PDMA0_CHCTL, mmio_read_32(REG_PDMA0_CHCTL) | PDMA_QSPI_CH_MSK);
+
+		/* enable RX before TX so no received word is missed */
+		mmio_write_32(REG_QSPI0_PDMACTL, QSPI_PDMACTL_RXPDMAEN);
+		mmio_write_32(REG_QSPI0_PDMACTL, QSPI_PDMACTL_RXPDMAEN | QSPI_PDMACTL_TXPDMAEN);
+
+		timeout = timeout_init_us(QSPI_PDMA_TIMEOUT_US);
+		while ((mmio_read_32(REG_PDMA0_TDSTS) & BIT_32(PDMA_QSPI_RX_CH)) == 0U)
+		{
+			if ((mmio_read_32(REG_PDMA0_ABTSTS) & PDMA_QSPI_CH_MSK) ||
+			    timeout_elapsed(timeout)) {
+				ERROR("QSPI PDMA transfer failed\n");
+				ret = -EIO;
+				break;
+			}
+		}
+
+		mmio_write_32(REG_QSPI0_PDMACTL, 0);
+		mmio_write_32(REG_PDMA0_TDSTS, PDMA_QSPI_CH_MSK);
+
+		if (ret != 0) {
+			mmio_write_32(REG_PDMA0_ABTSTS, PDMA_QSPI_CH_MSK);
+			mmio_write_32(REG_PDMA0_CHCTL, mmio_read_32(REG_PDMA0_CHCTL) & ~PDMA_QSPI_CH_MSK);
+			mmio_write_32(REG_QSPI0_PDMACTL, QSPI_PDMACTL_PDMARST);
+			mmio_write_32(REG_QSPI0_FIFOCTL, mmio_read_32(REG_QSPI0_FIFOCTL) | 0x3);
+			break;
+		}
+
+		buf += chunk;
+		count -= chunk;
+	}
+
+	return ret;
+}
+
+static int ma35d1_qspi_read_words(struct ma35d1_qspi_info *qspi, unsigned int *buf, unsigned int count)
+{
+	if (qspi->pdma_rx_req != 0)
+		return ma35d1_qspi_pdma_read(qspi, buf, count);
+
+	ma35d1_qspi_pio_read(buf, count);
+	return 0;
+}
+
 /***************************************************************/
 
 static void ma35d1_spinand_reset()
@@ -123,22 +257,35 @@ static void ma35d1_spinand_quad_enable()
 	ma35d1_spinand_setstatus(0xb0, status | 0x01);
 }
 
-static int ma35d1_spinand_singleread(struct ma35d1_qspi_info *spinand, unsigned int addr, unsigned int *buf)
+static int ma35d1_spinand_wait_ready(void)
+{
+	while(ma35d1_spinand_getstatus(0xc0) & 0x1);    // wait ready
+	if (ma35d1_spinand_getstatus(0xc0) & 0x20)
+	{
+		ERROR("Err-ECC\n");
+		return 1;
+	}
+	return 0;
+}
+
+/* Load a page from the array into the cache register */
+static int ma35d1_spinand_page_load(unsigned int addr)
 {
 	unsigned char cmd[4];
-	int volatile i;
 
 	cmd[0] = 0x13;  /* page read */
 	cmd[1] = (addr >> 16) & 0xFF;
 	cmd[2] = (addr >> 8) & 0xFF;
 	cmd[3] = addr & 0xFF;
 	nus3500_spi_sendcmd(cmd, 4, 0, 0);
-	while(ma35d1_spinand_getstatus(0xc0) & 0x1);    // wait ready
-	if (ma35d1_spinand_getstatus(0xc0) & 0x20)
-	{
-		ERROR("Err-ECC\n");
-		return 1;
-	}
+
+	return ma35d1_spinand_wait_ready();
+}
+
+/* Read len bytes from the cache register, starting at column 0 */
+static int ma35d1_spinand_singleread(struct ma35d1_qspi_info *spinand, unsigned int *buf, unsigned int len)
+{
+	int ret;
 
 	mmio_write_32(REG_QSPI0_SSCTL, 0x01);   // CS0 low
 
@@ -157,18 +304,12 @@ static int ma35d1_spinand_singleread(struct ma35d1_qspi_info *spinand, unsigned
 	mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL) & ~0x1F00) | (1<<19));
 
 	// read data
-	for (i=0; i<spinand->page_size/4; i++)
-	{
-		mmio_write_32(REG_QSPI0_TX, 0x00);
-		while(mmio_read_32(REG_QSPI0_STATUS) & 0x01);
-		*buf++ = mmio_read_32(REG_QSPI0_RX);
-	}
+	ret = ma35d1_qspi_read_words(spinand, buf, len/4);
 	mmio_write_32(REG_QSPI0_SSCTL, 0x05);   // CS0 high
 	// set DWIDTH to 8 bit and disable byte reorder
 	mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL) & ~0x80000) | (8<<8));
 
-
-	return 0;
+	return ret;
 }
 
 
@@ -197,47 +338,96 @@ static int ma35d1_spinand_read_oob(struct ma35d1_qspi_info *spinand, unsigned in
 }
 
 
-static int ma35d1_spinand_quadread(struct ma35d1_qspi_info *spinand, unsigned int addr, unsigned int *buf)
+/* QSPI0_CTL mode bits only change while the controller is disabled */
+static void ma35d1_qspi_set_ctl(unsigned int ctl)
 {
-	int volatile i;
-	unsigned char cmd[4];
+	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) & (~0x1));
+	while(mmio_read_32(REG_QSPI0_STATUS) & 0x8000);
+	mmio_write_32(REG_QSPI0_CTL, ctl & (~0x1));
+	mmio_write_32(REG_QSPI0_CTL, ctl | 0x1);
+	while((mmio_read_32(REG_QSPI0_STATUS) & 0x8000) == 0);
+}
 
-	cmd[0] = 0x13;  /* page read */
-	cmd[1] = (addr >> 16) & 0xFF;
-	cmd[2] = (addr >> 8) & 0xFF;
-	cmd[3] = addr & 0xFF;
-	nus3500_spi_sendcmd(cmd, 4, 0, 0);
-	while(ma35d1_spinand_getstatus(0xc0) & 0x1);    // wait ready
-	if (ma35d1_spinand_getstatus(0xc0) & 0x20)
-	{
-		ERROR("Err-ECC\n");
-		return 1;
+/*
+ * Work out the QSPI0_CTL values a quad read from cache switches between,
+ * once per run rather than once per page. The page reads leave the
+ * controller in ctl_single, so the values stay valid for the whole run.
+ */
+static void ma35d1_spinand_quad_ctl_init(struct ma35d1_qspi_info *spinand)
+{
+	unsigned int ctl = mmio_read_32(REG_QSPI0_CTL) & (~0x1);
+
+	/* quad output mode for the address phase of Quad IO Fast Read */
+	spinand->ctl_quad_out = (ctl & ~0xf00000) | 0x500000;
+	if (spinand->QuadReadCmd == CMD_READ_QUAD_IO_FAST)
+		ctl = spinand->ctl_quad_out;
+
+	/* quad input mode, 32-bit data width */
+	ctl = (ctl & ~0x101ff0) | 0x480000;
+	if (spinand->SuspendInterval == 0xff)
+		ctl |= 0x10;
+	else
+		ctl |= (spinand->SuspendInterval & 0xf) << 4;
+	spinand->ctl_quad_in = ctl;
+
+	/* back to single mode, 8-bit data width */
+	spinand->ctl_single = (ctl & ~0x4800f0) | 0x800;
+}
+
+/* Switch PD.2~PD.5 between QSPI0 quad data pins and WP#/HOLD# GPIO high */
+static void ma35d1_spinand_quad_pins(int enable)
+{
+	if (enable) {
+		mmio_write_32(SYS_GPD_MFPL, 0x00555555);
+	} else {
+		mmio_write_32(SYS_GPD_MFPL, 0x00005555);
+		mmio_write_32(GPIOD_MODE, 0x500);
+		mmio_write_32(GPIOD_DOUT, mmio_read_32(GPIOD_DOUT)|0x30);
 	}
+}
+
+/*
+ * Read len bytes from the cache register, starting at column 0, in quad
+ * mode. The CTL values must already be set up, see
+ * ma35d1_spinand_quad_ctl_init(). PD.4/PD.5 carry WP#/HOLD# outside the
+ * x4 data phase, so the quad pins are only selected around it.
+ *
+ * With cont set the device is in continuous read mode (BUF = 0): the
+ * command takes no column address, only cont_dummy dummy bytes, sent in
+ * the same mode as the address phase would be.
+ */
+static int ma35d1_spinand_quadread(struct ma35d1_qspi_info *spinand, unsigned int *buf, unsigned int len, int cont)
+{
+	int volatile i;
+	int ret;
+
 	/* read data */
 	mmio_write_32(REG_QSPI0_SSCTL, 0x01);   // CS0 low
 	mmio_write_32(REG_QSPI0_TX, spinand->QuadReadCmd);
 	while(mmio_read_32(REG_QSPI0_STATUS) & 0x01){}
 
 	if (spinand->QuadReadCmd == CMD_READ_QUAD_IO_FAST)
-	{
-		mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) & (~0x1));
-		while(mmio_read_32(REG_QSPI0_STATUS) & 0x8000);
-		mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL) & ~0xf00000) | 0x500000); // quad output mode
-		mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) | 0x1);
-		while((mmio_read_32(REG_QSPI0_STATUS) & 0x8000) == 0);
-	}
-	// dummy byte (between command and address)
-	for (i=0; i<spinand->dummybyte1; i++)
-		mmio_write_32(REG_QSPI0_TX, 0x00);
+		ma35d1_qspi_set_ctl(spinand->ctl_quad_out);
 
-	// column address
-	mmio_write_32(REG_QSPI0_TX, 0x00);
-	mmio_write_32(REG_QSPI0_TX, 0x00);
-	while(mmio_read_32(REG_QSPI0_STATUS) & 0x20000); /* For 4-level FIFO buffer SPI port */
+	if (cont) {
+		for (i=0; i<spinand->cont_dummy; i++) {
+			while(mmio_read_32(REG_QSPI0_STATUS) & 0x20000); /* TX FIFO full */
+			mmio_write_32(REG_QSPI0_TX, 0x00);
+		}
+	} else {
+		// dummy byte (between command and address)
+		for (i=0; i<spinand->dummybyte1; i++)
+			mmio_write_32(REG_QSPI0_TX, 0x00);
 
-	// dummy byte (between address and data)
-	for (i=0; i<spinand->dummybyte2; i++)
+		// column address
 		mmio_write_32(REG_QSPI0_TX, 0x00);
+		mmio_write_32(REG_QSPI0_TX, 0x00);
+		while(mmio_read_32(REG_QSPI0_STATUS) & 0x20000); /* For 4-level FIFO buffer SPI port */
+
+		// dummy byte (between address and data)
+		for (i=0; i<spinand->dummybyte2; i++)
+			mmio_write_32(REG_QSPI0_TX, 0x00);
+	}
 
 	// wait tx finish
 	while(mmio_read_32(REG_QSPI0_STATUS) & 0x01){}
@@ -247,51 +437,37 @@ static int ma35d1_spinand_quadread(struct ma35d1_qspi_info *spinand, unsigned in
 	while(mmio_read_32(REG_QSPI0_STATUS) & 0x800000);
 
 	/* Enable Quad IO input mode */
-	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) & (~0x1));
-	while(mmio_read_32(REG_QSPI0_STATUS) & 0x8000);
-	mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL)& ~0x101ff0)| 0x480000);
-	if (spinand->SuspendInterval == 0xff)
-		mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) | 0x10);
-	else
-		mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) | ((spinand->SuspendInterval & 0xf) << 4));
-	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) | 0x1);
-	while((mmio_read_32(REG_QSPI0_STATUS) & 0x8000) == 0);
-	mmio_write_32(SYS_GPD_MFPL, 0x00555555);
+	ma35d1_qspi_set_ctl(spinand->ctl_quad_in);
+	ma35d1_spinand_quad_pins(1);
 
 	// read data
-	for (i=0; i<spinand->page_size/4; i++)
-	{
-		mmio_write_32(REG_QSPI0_TX, 0x00);
-		while(mmio_read_32(REG_QSPI0_STATUS) & 0x01);
-		*buf++ = mmio_read_32(REG_QSPI0_RX);
-	}
+	ret = ma35d1_qspi_read_words(spinand, buf, len/4);
 
 	mmio_write_32(REG_QSPI0_SSCTL, 0x05);   // CS0 high
-	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) & (~0x1));
-	while(mmio_read_32(REG_QSPI0_STATUS) & 0x8000);
-	mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL)& ~0x4800f0) | 0x800); // disable quad mode
-	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) | 0x1);
-	while((mmio_read_32(REG_QSPI0_STATUS) & 0x8000) == 0);
-	mmio_write_32(SYS_GPD_MFPL, 0x00005555);
-	mmio_write_32(GPIOD_MODE, 0x500);
-	mmio_write_32(GPIOD_DOUT, mmio_read_32(GPIOD_DOUT)|0x30);
+	ma35d1_qspi_set_ctl(spinand->ctl_single); // disable quad mode
+	ma35d1_spinand_quad_pins(0);
 
-	return 0;
+	return ret;
 }
 
-static int ma35d1_spinand_read_pages(struct ma35d1_qspi_info *spinand, uintptr_t buf, int page_start, int page_count)
+static int ma35d1_spinand_read_cache(struct ma35d1_qspi_info *spinand, uintptr_t buf, unsigned int len)
+{
+	if (spinand->is_quad)
+		return ma35d1_spinand_quadread(spinand, (unsigned int *)buf, len, 0);
+	else
+		return ma35d1_spinand_singleread(spinand, (unsigned int *)buf, len);
+}
+
+/* One PAGE READ and one read from cache per page */
+static int ma35d1_spinand_read_pages_single(struct ma35d1_qspi_info *spinand, uintptr_t buf, int page_start, int page_count)
 {
 	while (page_count > 0)
 	{
-		if (spinand->is_quad) {
-			if (ma35d1_spinand_quadread(spinand, page_start, (unsigned int *)buf)) {
-				return -EBADMSG;
-			}
-		} else {
-			if (ma35d1_spinand_singleread(spinand, page_start, (unsigned int *)buf)) {
-				return -EBADMSG;
-			}
-		}
+		if (ma35d1_spinand_page_load(page_start))
+			return -EBADMSG;
+		if (ma35d1_spinand_read_cache(spinand, buf, spinand->page_size))
+			return -EIO;
+
 		buf += spinand->page_size;
 		page_count--;
 		page_start++;
@@ -299,6 +475,90 @@ static int ma35d1_spinand_read_pages(struct ma35d1_qspi_info *spinand, uintptr_t
 	return 0;
 }
 
+/*
+ * READ PAGE CACHE SEQUENTIAL (0x31) moves the loaded page into the cache
+ * register and starts loading the next one, so tR of page N+1 is hidden
+ * behind the transfer of page N. READ PAGE CACHE LAST (0x3F) moves the
+ * final page without starting another array read.
+ */
+static int ma35d1_spinand_read_pages_cache(struct ma35d1_qspi_info *spinand, uintptr_t buf, int page_start, int page_count)
+{
+	unsigned char cmd[1];
+
+	if (ma35d1_spinand_page_load(page_start))
+		return -EBADMSG;
+
+	while (page_count > 0)
+	{
+		cmd[0] = (page_count > 1) ? CMD_SPINAND_READ_CACHE_SEQ : CMD_SPINAND_READ_CACHE_END;
+		nus3500_spi_sendcmd(cmd, 1, 0, 0);
+		if (ma35d1_spinand_wait_ready())
+			return -EBADMSG;
+		if (ma35d1_spinand_read_cache(spinand, buf, spinand->page_size))
+			return -EIO;
+
+		buf += spinand->page_size;
+		page_count--;
+	}
+	return 0;
+}
+
+/*
+ * With the buffer mode bit cleared, a single read from cache keeps
+ * streaming the following pages while the device loads them in the
+ * background, so the whole run is one transfer. This follows the Winbond
+ * W25N layout: the read command has no column address, 0x03 takes three
+ * dummy bytes (the same length as with BUF = 1, so the single mode read
+ * is unchanged) and 0x6B/0x0B take four, set by spinand-cont-dummy.
+ *
+ * The device only reports the worst ECC result of the whole stream. If it
+ * flags an uncorrectable page, the run is read again one page at a time
+ * in buffer mode, which checks each page on its own.
+ */
+static int ma35d1_spinand_read_pages_continuous(struct ma35d1_qspi_info *spinand, uintptr_t buf, int page_start, int page_count)
+{
+	unsigned int status;
+	int ret = 0;
+
+	status = ma35d1_spinand_getstatus(0xb0);
+	ma35d1_spinand_setstatus(0xb0, status & ~SPINAND_CFG_BUF);
+
+	if (ma35d1_spinand_page_load(page_start)) {
+		ret = -EBADMSG;
+	} else {
+		if (spinand->is_quad)
+			ret = ma35d1_spinand_quadread(spinand, (unsigned int *)buf,
+						      spinand->page_size * page_count, 1);
+		else
+			ret = ma35d1_spinand_singleread(spinand, (unsigned int *)buf,
+							spinand->page_size * page_count);
+		if (ret)
+			ret = -EIO;
+		/* CS high ends the stream, wait for the pending page load */
+		if (ma35d1_spinand_wait_ready())
+			ret = -EBADMSG;
+	}
+
+	ma35d1_spinand_setstatus(0xb0, status | SPINAND_CFG_BUF);
+
+	if (ret == -EBADMSG)
+		return ma35d1_spinand_read_pages_single(spinand, buf, page_start, page_count);
+	return ret;
+}
+
+static int ma35d1_spinand_read_pages(struct ma35d1_qspi_info *spinand, uintptr_t buf, int page_start, int page_count)
+{
+	if (spinand->is_quad)
+		ma35d1_spinand_quad_ctl_init(spinand);
+
+	if ((spinand->seq_read == SPINAND_SEQ_READ_CACHE) && (page_count > 1))
+		return ma35d1_spinand_read_pages_cache(spinand, buf, page_start, page_count);
+	else if ((spinand->seq_read == SPINAND_SEQ_READ_CONTINUOUS) && (page_count > 1))
+		return ma35d1_spinand_read_pages_continuous(spinand, buf, page_start, page_count);
+	else
+		return ma35d1_spinand_read_pages_single(spinand, buf, page_start, page_count);
+}
+
 
 static int ma35d1_spinand_block_isbad(struct ma35d1_qspi_info *spinand, unsigned int block)
 {
@@ -316,6 +576,23 @@ static int ma35d1_spinand_block_isbad(struct ma35d1_qspi_info *spinand, unsigned
 	return 0;   /* good block */
 }
 
+static int ma35d1_spinand_bbt_isbad(struct ma35d1_qspi_info *spinand, unsigned int block)
+{
+	unsigned int idx = block / 32U;
+	uint32_t mask = BIT_32(block % 32U);
+
+	if (block >= SPINAND_BBT_MAX_BLOCKS)
+		return ma35d1_spinand_block_isbad(spinand, block);
+
+	if ((spinand_bbt_scanned[idx] & mask) == 0U) {
+		if (ma35d1_spinand_block_isbad(spinand, block))
+			spinand_bbt_bad[idx] |= mask;
+		spinand_bbt_scanned[idx] |= mask;
+	}
+
+	return (spinand_bbt_bad[idx] & mask) != 0U;
+}
+
 
 static size_t parse_spinand_read(struct ma35d1_qspi_info *spinand, int lba, uintptr_t buf, size_t size)
 {
@@ -329,7 +606,7 @@ static size_t parse_spinand_read(struct ma35d1_qspi_info *spinand, int lba, uint
 	int page_count, ret;
 
 	while (pages_to_read) {
-		ret = ma35d1_spinand_block_isbad(spinand, block);
+		ret = ma35d1_spinand_bbt_isbad(spinand, block);
 		if (ret) {
 			block++;
 			if ((--block_count) <= 0)
@@ -385,6 +662,27 @@ int ma35d1_qspi_init(void)
 
 static void *fdt = (void *)(uintptr_t)MA35D1_DTB_BASE;
 
+/*
+ * The data phase runs through PDMA0 when the device tree gives the PDMA
+ * request sources of QSPI0 ("spi-pdma-tx-req" and "spi-pdma-rx-req"),
+ * otherwise it is PIO.
+ */
+static void ma35d1_qspi_pdma_setup(struct ma35d1_qspi_info *qspi, int node)
+{
+	qspi->pdma_tx_req = fdt_read_uint32_default(fdt, node, "spi-pdma-tx-req", 0);
+	qspi->pdma_rx_req = fdt_read_uint32_default(fdt, node, "spi-pdma-rx-req", 0);
+
+	if ((qspi->pdma_tx_req == 0) || (qspi->pdma_rx_req == 0)) {
+		qspi->pdma_tx_req = 0;
+		qspi->pdma_rx_req = 0;
+		return;
+	}
+
+	/* enable PDMA0 clock */
+	mmio_write_32(CLK_SYSCLK0, mmio_read_32(CLK_SYSCLK0) | (1 << 12));
+	INFO("QSPI: PDMA data transfer\n");
+}
+
 static void ma35d1_spinand_setup(struct ma35d1_qspi_info *spinand)
 {
 	int node;
@@ -411,6 +709,9 @@ static void ma35d1_spinand_setup(struct ma35d1_qspi_info *spinand)
 	spinand->dummybyte1 = fdt_read_uint32_default(fdt, node, "spi-dummy1", 0);
 	spinand->dummybyte2 = fdt_read_uint32_default(fdt, node, "spi-dummy2", 0);
 	spinand->SuspendInterval = fdt_read_uint32_default(fdt, node, "spi-suspend-interval", 0);
+	spinand->seq_read = fdt_read_uint32_default(fdt, node, "spinand-seq-read", SPINAND_SEQ_READ_NONE);
+	spinand->cont_dummy = fdt_read_uint32_default(fdt, node, "spinand-cont-dummy", 4);
+	ma35d1_qspi_pdma_setup(spinand, node);
 
 	INFO("SPINAND: Size %liMB, Page %i, pages per block %i, oob size %i\n", (spinand->size/1024)/1024, spinand->page_size, 
 		spinand->pages_per_block, spinand->oob_size);
@@ -456,10 +757,10 @@ static int ma35d1_spinor_reset(void)
 }
 
 
-int spinor_single_read(unsigned int addr, unsigned int len, unsigned int *buf)
+int spinor_single_read(struct ma35d1_qspi_info *spinor, unsigned int addr, unsigned int len, unsigned int *buf)
 {
-	int volatile i;
 	unsigned int count;
+	int ret;
 
 	mmio_write_32(REG_QSPI0_SSCTL, 0x01);   // CS0 low
 
@@ -478,18 +779,13 @@ int spinor_single_read(unsigned int addr, unsigned int len, unsigned int *buf)
 	mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL) & ~0x1F00) | (1<<19));
 
 	// read data
-	count = (len / 4) + 1;
-	for (i=0; i<count; i++)
-	{
-		mmio_write_32(REG_QSPI0_TX, 0x00);
-		while(mmio_read_32(REG_QSPI0_STATUS) & 0x01);
-		*buf++ = mmio_read_32(REG_QSPI0_RX);
-	}
+	count = div_round_up(len, 4);
+	ret = ma35d1_qspi_read_words(spinor, buf, count);
 	mmio_write_32(REG_QSPI0_SSCTL, 0x05);   // CS0 high
 	// set DWIDTH to 8 bit and disable byte reorder
 	mmio_write_32(REG_QSPI0_CTL, (mmio_read_32(REG_QSPI0_CTL) & ~0x80000) | (8<<8));
 
-	return 0;
+	return ret;
 }
 
 int ma35d1_spinor_quad_enable(struct ma35d1_qspi_info *spinor)
@@ -551,6 +847,7 @@ int spinor_quad_read(struct ma35d1_qspi_info *spinor, unsigned int addr, unsigne
 {
 	int volatile i;
 	int volatile count;
+	int ret;
 
 	ma35d1_spinor_quad_enable(spinor);
 
@@ -599,14 +896,9 @@ int spinor_quad_read(struct ma35d1_qspi_info *spinor, unsigned int addr, unsigne
 	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) | 0x1);
 	while((mmio_read_32(REG_QSPI0_STATUS) & 0x8000) == 0);
 
-	count = (len / 4) + 1;
+	count = div_round_up(len, 4);
 	// read data
-	for (i=0; i<count; i++)
-	{
-		mmio_write_32(REG_QSPI0_TX, 0x00);
-		while(mmio_read_32(REG_QSPI0_STATUS) & 0x01);
-		*buf++ = mmio_read_32(REG_QSPI0_RX);
-	}
+	ret = ma35d1_qspi_read_words(spinor, buf, count);
 
 	mmio_write_32(REG_QSPI0_SSCTL, 0x05);   // CS0 high
 	mmio_write_32(REG_QSPI0_CTL, mmio_read_32(REG_QSPI0_CTL) & (~0x1));
@@ -618,19 +910,21 @@ int spinor_quad_read(struct ma35d1_qspi_info *spinor, unsigned int addr, unsigne
 	// disable quad mode
 	ma35d1_spinor_reset();
 
-	return 0;
+	return ret;
 }
 
 
 static size_t parse_spinor_read(struct ma35d1_qspi_info *spinor, int lba, uintptr_t buf, size_t size)
 {
+	int ret;
+
 	if (spinor->is_quad)
-		spinor_quad_read(spinor, lba*SPINOR_BLOCK_SIZE, size, (unsigned int *)buf);
+		ret = spinor_quad_read(spinor, lba*SPINOR_BLOCK_SIZE, size, (unsigned int *)buf);
 	else
-		spinor_single_read(lba*SPINOR_BLOCK_SIZE, size, (unsigned int *)buf);
+		ret = spinor_single_read(spinor, lba*SPINOR_BLOCK_SIZE, size, (unsigned int *)buf);
 
 	/* number of read bytes */
-	return size;
+	return (ret == 0) ? size : 0;
 }
 
 
@@ -658,6 +952,7 @@ static void ma35d1_spinor_setup(struct ma35d1_qspi_info *spinor)
 	spinor->dummybyte1 = fdt_read_uint32_default(fdt, node, "spi-dummy1", 0);
 	spinor->dummybyte2 = fdt_read_uint32_default(fdt, node, "spi-dummy2", 0);
 	spinor->SuspendInterval = fdt_read_uint32_default(fdt, node, "spi-suspend-interval", 0);
+	ma35d1_qspi_pdma_setup(spinor, node);
 
 	/* reset spi nor */
 	ma35d1_spinor_reset();
@@ -684,6 +979,7 @@ static struct io_block_dev_spec spinand_dev_spec = {
 		.read = ma35d1_spinand_read,
 	},
 	/* fill .block_size at run-time */
+	.flags = IO_BLOCK_FLAG_DIRECT_READ,
 };
 
 int ma35d1_spinand_init(struct io_block_dev_spec **block_dev_spec, long *offset, int is_quad)
@@ -692,6 +988,10 @@ int ma35d1_spinand_init(struct io_block_dev_spec **block_dev_spec, long *offset,
 	ma35d1_spinand_setup(&ma35d1_qspi);
 	*offset = ma35d1_qspi.offset;
 
+	/* start from an empty bad block table */
+	memset(spinand_bbt_scanned, 0, sizeof(spinand_bbt_scanned));
+	memset(spinand_bbt_bad, 0, sizeof(spinand_bbt_bad));
+
 	spinand_dev_spec.block_size = ma35d1_qspi.page_size;
 
 	*block_dev_spec = &spinand_dev_spec;
@@ -720,6 +1020,7 @@ static struct io_block_dev_spec spinor_dev_spec = {
 		.read = ma35d1_spinor_read,
 	},
 	.block_size = SPINOR_BLOCK_SIZE,
+	.flags = IO_BLOCK_FLAG_DIRECT_READ,
 };
 
 int ma35d1_spinor_init(struct io_block_dev_spec **block_dev_spec, long *offset, int is_quad)
@@ -46,6 +46,18 @@ struct mmc {
 	unsigned int csd[4];
 	long offset;	/* image offset in nand */
 	int bus_width;
+	int adma2;	/* controller supports ADMA2 */
+	int adma_active;	/* current data transfer uses ADMA2 */
+	unsigned int caps;	/* MMC_CAP_* allowed by the board */
+	unsigned int max_freq;	/* board clock limit, 0 = none */
+	int timing;	/* negotiated MMC_TIMING_* */
+};
+
+/* ADMA2 descriptor, 32-bit addressing */
+struct sdh_adma2_desc {
+	uint16_t attr;
+	uint16_t len;
+	uint32_t addr;
 };
 
 
@@ -55,6 +67,32 @@ struct mmc ma35d1_mmc;
 #define SDH_CMD_MAX_TIMEOUT         32000
 #define SDH_CMD_DEFAULT_TIMEOUT     10000
 #define SDH_MAX_DIV_SPEC_300        2046
+#define SDH_DATA_TIMEOUT_US         20000000
+#define SDH_BASE_CLOCK              180000000
+#define SDH_TUNING_LOOPS            40
+
+#define SD_FREQ_LEGACY              25000000
+#define SD_FREQ_HS                  50000000
+#define MMC_FREQ_LEGACY             26000000
+#define MMC_FREQ_HS                 52000000
+#define MMC_FREQ_HS200              200000000
+
+/*
+ * One descriptor moves up to SDH_ADMA2_MAX_LEN bytes and may not cross a
+ * 128MB boundary. The table covers a full io_block buffer (2MB) in a
+ * single command; larger reads are split by ma35d1_sdhc_read().
+ */
+#define SDH_ADMA2_MAX_DESC          64
+#define SDH_ADMA2_MAX_LEN           0x8000U
+#define SDH_ADMA2_BOUNDARY          0x8000000U
+#define SDH_ADMA2_MAX_XFER          (SDH_ADMA2_MAX_DESC * SDH_ADMA2_MAX_LEN)
+
+static struct sdh_adma2_desc sdh_adma2_table[SDH_ADMA2_MAX_DESC]
+	__aligned(CACHE_WRITEBACK_GRANULE);
+static unsigned int sdh_adma2_count;
+
+/* EXT_CSD and CMD6 status block */
+static unsigned char sdh_status_buf[512] __aligned(CACHE_WRITEBACK_GRANULE);
 
 /*********************************************************/
 static void sdh_reset(struct mmc *mmc, unsigned char mask)
@@ -92,10 +130,23 @@ static void sdh_set_clock(struct mmc *mmc, unsigned int clock)
 
 	mmio_write_16(mmc->base+SDH_CLOCK_CONTROL, 0);
 
-	/* Version 3.00 divisors must be a multiple of 2. */
-	div = (180000000 / 2) / clock;
+	if ((mmc->max_freq != 0) && (clock > mmc->max_freq))
+		clock = mmc->max_freq;
+
+	/*
+	 * Version 3.00 divisors must be a multiple of 2. Round up so the
+	 * card is never clocked above the requested rate.
+	 */
+	if (clock >= SDH_BASE_CLOCK) {
+		div = 0;
+	} else {
+		div = div_round_up(SDH_BASE_CLOCK, 2 * clock);
+		if (div > (SDH_MAX_DIV_SPEC_300 / 2))
+			div = SDH_MAX_DIV_SPEC_300 / 2;
+	}
 
 	clk |= (div & 0xff) << 8;
+	clk |= ((div >> 8) & 0x3) << 6;
 	clk |= 0x01;    //SDHCI_CLOCK_INT_EN;
 	mmio_write_16(mmc->base+SDH_CLOCK_CONTROL, clk);
 
@@ -120,6 +171,53 @@ static void sdh_set_power(struct mmc *mmc)
 	mmio_write_8(mmc->base+SDH_POWER_CONTROL, 0xF);
 }
 
+/*
+ * Program the host side of a bus timing. The card clock is gated while
+ * the UHS mode changes; the next sdh_set_clock() enables it again.
+ */
+static void sdh_set_timing(struct mmc *mmc, int timing)
+{
+	unsigned int ctrl, ctrl2;
+
+	mmio_write_16(mmc->base + SDH_CLOCK_CONTROL,
+				mmio_read_16(mmc->base + SDH_CLOCK_CONTROL) & ~0x4);
+
+	ctrl = mmio_read_8(mmc->base + SDH_HOST_CONTROL);
+	ctrl2 = mmio_read_16(mmc->base + SDH_HOST_CONTROL2);
+
+	if (timing == MMC_TIMING_LEGACY)
+		ctrl &= ~SDH_CTRL_HISPD;
+	else
+		ctrl |= SDH_CTRL_HISPD;
+
+	if (timing == MMC_TIMING_MMC_DDR52) {
+		ctrl2 = (ctrl2 & ~SDH_CTRL2_UHS_MASK) | SDH_CTRL2_UHS_DDR50;
+	} else if (timing == MMC_TIMING_MMC_HS200) {
+		ctrl2 = (ctrl2 & ~SDH_CTRL2_UHS_MASK) | SDH_CTRL2_UHS_SDR104;
+		ctrl2 |= SDH_CTRL2_VDD_180;
+	} else {
+		/* legacy and high speed: no UHS mode, 3.3V signalling */
+		ctrl2 &= ~(SDH_CTRL2_UHS_MASK | SDH_CTRL2_VDD_180);
+	}
+
+	mmio_write_8(mmc->base + SDH_HOST_CONTROL, ctrl);
+	mmio_write_16(mmc->base + SDH_HOST_CONTROL2, ctrl2);
+	mmc->timing = timing;
+}
+
+static void sdh_set_bus_width(struct mmc *mmc, int width)
+{
+	unsigned int ctrl;
+
+	ctrl = mmio_read_8(mmc->base + SDH_HOST_CONTROL);
+	ctrl &= ~(SDH_CTRL_4BITBUS | SDH_CTRL_8BITBUS);
+	if (width == 8)
+		ctrl |= SDH_CTRL_8BITBUS;
+	else if (width == 4)
+		ctrl |= SDH_CTRL_4BITBUS;
+	mmio_write_8(mmc->base + SDH_HOST_CONTROL, ctrl);
+}
+
 
 static void sdh_cmd_done(struct mmc *mmc, struct mmc_cmd *cmd)
 {
@@ -140,11 +238,74 @@ static void sdh_cmd_done(struct mmc *mmc, struct mmc_cmd *cmd)
 	}
 }
 
+/*
+ * ADMA2 descriptor table helpers. Segments are appended with
+ * sdh_adma2_add() and the chain is closed by sdh_adma2_finish(), so a
+ * request may gather any number of buffers up to SDH_ADMA2_MAX_DESC
+ * descriptors.
+ */
+static void sdh_adma2_reset(void)
+{
+	sdh_adma2_count = 0;
+}
+
+static int sdh_adma2_add(uintptr_t addr, size_t len)
+{
+	struct sdh_adma2_desc *desc;
+	size_t chunk;
+
+	while (len > 0) {
+		if (sdh_adma2_count >= SDH_ADMA2_MAX_DESC)
+			return -ENOMEM;
+
+		chunk = MIN(len, (size_t)SDH_ADMA2_MAX_LEN);
+		chunk = MIN(chunk, (size_t)(SDH_ADMA2_BOUNDARY -
+				(addr & (SDH_ADMA2_BOUNDARY - 1))));
+
+		desc = &sdh_adma2_table[sdh_adma2_count++];
+		desc->attr = SDH_ADMA2_VALID | SDH_ADMA2_ACT_TRAN;
+		desc->len = chunk;
+		desc->addr = addr;
+
+		addr += chunk;
+		len -= chunk;
+	}
+	return 0;
+}
+
+static int sdh_adma2_finish(struct mmc *mmc)
+{
+	if (sdh_adma2_count == 0)
+		return -EINVAL;
+
+	sdh_adma2_table[sdh_adma2_count - 1].attr |= SDH_ADMA2_END;
+	flush_dcache_range((uintptr_t)sdh_adma2_table,
+			   sdh_adma2_count * sizeof(struct sdh_adma2_desc));
+
+	mmio_write_32(mmc->base + SDH_ADMA_ADDRESS,
+		      (unsigned long)sdh_adma2_table);
+	return 0;
+}
+
 static int sdh_transfer_data(struct mmc *mmc, struct mmc_data *data)
 {
 	unsigned int stat, /*rdy, mask,*/ timeout /*, block = 0*/;
 	char transfer_done = 0;
 	unsigned long start_addr;
+	uint64_t adma_timeout;
+
+	if (mmc->adma_active) {
+		/* the whole chain runs without CPU intervention */
+		adma_timeout = timeout_init_us(SDH_DATA_TIMEOUT_US);
+		do {
+			stat = mmio_read_32(mmc->base+SDH_INT_STATUS);
+			if (stat & 0x8000)   /* SDHCI_INT_ERROR */
+				return -1;
+			if (timeout_elapsed(adma_timeout))
+				return -2;
+		} while (!(stat & 0x2));    /* SDHCI_INT_DATA_END */
+		return 0;
+	}
 
 	if (data->flags == MMC_DATA_READ)
 		start_addr = (unsigned long) data->dest;
@@ -185,6 +346,7 @@ static int sdh_send_command(struct mmc *mmc,
 	int ret = 0;
 	unsigned int mask, flags, mode;
 	unsigned int time = 0;
+	unsigned long addr;
 	/* Timeout unit - ms */
 	unsigned int cmd_timeout = SDH_CMD_DEFAULT_TIMEOUT;
 
@@ -242,17 +404,33 @@ static int sdh_send_command(struct mmc *mmc,
 
 		if (data->flags == MMC_DATA_READ) {
 			mode |= 0x10;   /* SDHCI_TRNS_READ */
-			mmio_write_32(mmc->base + SDH_DMA_ADDRESS,
-						(unsigned long) data->dest);
+			addr = (unsigned long) data->dest;
 		} else {
-			mmio_write_32(mmc->base +
-						SDH_DMA_ADDRESS,
-						(unsigned long) data->src);
+			addr = (unsigned long) data->src;
 		}
 		mode |= 0x1; /* schung: SDH_DMA */
-		mmio_write_8(mmc->base + SDH_HOST_CONTROL,
-				       mmio_read_8(mmc->base +
-				       SDH_HOST_CONTROL) & (~0x18));
+
+		/* prefer ADMA2, fall back to SDMA */
+		mmc->adma_active = 0;
+		if (mmc->adma2) {
+			sdh_adma2_reset();
+			if ((sdh_adma2_add(addr, data->blocks * data->blocksize) == 0) &&
+			    (sdh_adma2_finish(mmc) == 0))
+				mmc->adma_active = 1;
+		}
+
+		if (mmc->adma_active) {
+			mmio_write_8(mmc->base + SDH_HOST_CONTROL,
+					       (mmio_read_8(mmc->base +
+					       SDH_HOST_CONTROL) & ~SDH_CTRL_DMA_MASK) |
+					       SDH_CTRL_ADMA32);
+		} else {
+			mmio_write_32(mmc->base + SDH_DMA_ADDRESS, addr);
+			mmio_write_8(mmc->base + SDH_HOST_CONTROL,
+					       (mmio_read_8(mmc->base +
+					       SDH_HOST_CONTROL) & ~SDH_CTRL_DMA_MASK) |
+					       SDH_CTRL_SDMA);
+		}
 
 		mmio_write_16(mmc->base +
 					 SDH_BLOCK_SIZE, 0x7000 |
@@ -300,6 +478,70 @@ static int sdh_send_command(struct mmc *mmc,
 }
 
 
+static int mmc_send_status(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+	int err, timeout = 1000;
+
+	while (1) {
+		cmd.cmdidx = MMC_CMD_SEND_STATUS;
+		cmd.resp_type = MMC_RSP_R1;
+		cmd.cmdarg = mmc->rca;
+		err = sdh_send_command(mmc, &cmd, 0);
+		if (err)
+			return err;
+
+		if (cmd.response[0] & MMC_STATUS_SWITCH_ERROR)
+			return -EIO;
+		if ((cmd.response[0] & MMC_STATUS_READY_FOR_DATA) &&
+		    (MMC_STATUS_CURR_STATE(cmd.response[0]) == MMC_STATE_TRAN))
+			return 0;
+
+		if (timeout-- <= 0)
+			return -ETIMEDOUT;
+		udelay(1000);
+	}
+}
+
+static int mmc_switch(struct mmc *mmc, unsigned char index,
+		      unsigned char value)
+{
+	struct mmc_cmd cmd;
+	int err;
+
+	cmd.cmdidx = MMC_CMD_SWITCH;
+	cmd.resp_type = MMC_RSP_R1b;
+	cmd.cmdarg = (MMC_SWITCH_MODE_WRITE_BYTE << 24) | (index << 16) |
+		     (value << 8);
+	err = sdh_send_command(mmc, &cmd, 0);
+	if (err)
+		return err;
+
+	return mmc_send_status(mmc);
+}
+
+static int mmc_read_ext_csd(struct mmc *mmc)
+{
+	struct mmc_cmd cmd;
+	struct mmc_data data;
+	int err;
+
+	cmd.cmdidx = MMC_CMD_SEND_EXT_CSD;
+	cmd.resp_type = MMC_RSP_R1;
+	cmd.cmdarg = 0;
+
+	data.dest = (char *)sdh_status_buf;
+	data.blocksize = sizeof(sdh_status_buf);
+	data.blocks = 1;
+	data.flags = MMC_DATA_READ;
+
+	inv_dcache_range((uintptr_t)sdh_status_buf, sizeof(sdh_status_buf));
+	err = sdh_send_command(mmc, &cmd, &data);
+	inv_dcache_range((uintptr_t)sdh_status_buf, sizeof(sdh_status_buf));
+
+	return err;
+}
+
 int sdh_select_card(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
@@ -321,35 +563,16 @@ int sdh_select_card(struct mmc *mmc)
 		sdh_send_command(mmc, &cmd, 0);
 
 		/* Set bus width */
-		mmio_write_8(mmc->base + SDH_HOST_CONTROL,
-				       mmio_read_8(mmc->base +
-				       /* SDH_CTRL_4BITBUS */
-				       SDH_HOST_CONTROL) | 0x2);
-	} else {  /* eMMC */
-		cmd.cmdidx = SD_CMD_SWITCH_FUNC;
-		cmd.resp_type = MMC_RSP_R1b;
-		if (mmc->bus_width == 4) {
-			/*
-			 * Set CMD6 argument Access field to 3,
-			 * Index to 183, Value to 1 (4-bit mode)
-			 */
-			cmd.cmdarg = (3ul << 24) | (183ul << 16) | (1ul << 8);
-			mmio_write_8(mmc->base + SDH_HOST_CONTROL,
-					       mmio_read_8(mmc->base +
-					       /* SDH_CTRL_4BITBUS */
-					       SDH_HOST_CONTROL) | 0x2);
-		} else { /* 8-bit */
-			/*
-			 * set CMD6 argument Access field to 3, Index to
-			 * 183, Value to 2 (8-bit mode)
-			 */
-			cmd.cmdarg = (3ul << 24) | (183ul << 16) | (2ul << 8);
-			mmio_write_8(mmc->base + SDH_HOST_CONTROL,
-					       mmio_read_8(mmc->base +
-					       /* SDHCI_CTRL_8BITBUS */
-					       SDH_HOST_CONTROL) | 0x20);
+		sdh_set_bus_width(mmc, 4);
+	} else if (mmc->bus_width > 1) {  /* eMMC */
+		if (mmc_switch(mmc, EXT_CSD_BUS_WIDTH,
+			       (mmc->bus_width == 8) ? EXT_CSD_BUS_WIDTH_8 :
+						       EXT_CSD_BUS_WIDTH_4) == 0) {
+			sdh_set_bus_width(mmc, mmc->bus_width);
+		} else {
+			WARN("eMMC %d-bit bus switch failed\n", mmc->bus_width);
+			mmc->bus_width = 1;
 		}
-		sdh_send_command(mmc, &cmd, 0);
 	}
 
 	/* set block length */
@@ -430,6 +653,7 @@ static int sd_switch(struct mmc *mmc, int mode,
 {
 	struct mmc_cmd cmd;
 	struct mmc_data data;
+	int err;
 
 	/* Switch the frequency */
 	cmd.cmdidx = SD_CMD_SWITCH_FUNC;
@@ -443,20 +667,173 @@ static int sd_switch(struct mmc *mmc, int mode,
 	data.blocks = 1;
 	data.flags = MMC_DATA_READ;
 
-	return sdh_send_command(mmc, &cmd, &data);
+	inv_dcache_range((uintptr_t)resp, 64);
+	err = sdh_send_command(mmc, &cmd, &data);
+	inv_dcache_range((uintptr_t)resp, 64);
+
+	return err;
+}
+
+/*
+ * Standard SDHCI 3.0 tuning: the controller steps its sampling point
+ * across CMD21 tuning blocks until it clears EXEC_TUNING.
+ */
+static int sdh_execute_tuning(struct mmc *mmc)
+{
+	unsigned int ctrl2, stat;
+	int i, timeout;
+
+	mmio_write_16(mmc->base + SDH_HOST_CONTROL2,
+				mmio_read_16(mmc->base + SDH_HOST_CONTROL2) |
+				SDH_CTRL2_EXEC_TUNING);
+
+	for (i = 0; i < SDH_TUNING_LOOPS; i++) {
+		mmio_write_32(mmc->base+SDH_INT_STATUS, 0xffffffff);
+		mmio_write_16(mmc->base + SDH_BLOCK_SIZE, 0x7000 |
+					((mmc->bus_width == 8) ? 128 : 64));
+		mmio_write_16(mmc->base+SDH_BLOCK_COUNT, 1);
+		mmio_write_16(mmc->base+SDH_XFER_MODE, 0x10); /* SDHCI_TRNS_READ */
+		mmio_write_32(mmc->base+SDH_ARGUMENT, 0);
+		mmio_write_16(mmc->base+SDH_COMMAND,
+					SDH_MAKE_CMD(MMC_CMD_SEND_TUNING_BLOCK_HS200,
+						     (SDH_CMD_RESP_SHORT | SDH_CMD_CRC |
+						      SDH_CMD_INDEX | SDH_CMD_DATA)));
+
+		timeout = 1000;
+		do {
+			stat = mmio_read_32(mmc->base+SDH_INT_STATUS);
+			if (timeout-- <= 0)
+				break;
+			udelay(1);
+		} while (!(stat & SDH_INT_DATA_AVAIL));
+
+		ctrl2 = mmio_read_16(mmc->base + SDH_HOST_CONTROL2);
+		if (!(ctrl2 & SDH_CTRL2_EXEC_TUNING))
+			break;
+	}
+
+	mmio_write_32(mmc->base+SDH_INT_STATUS, 0xffffffff);
+
+	ctrl2 = mmio_read_16(mmc->base + SDH_HOST_CONTROL2);
+	if ((ctrl2 & SDH_CTRL2_EXEC_TUNING) || !(ctrl2 & SDH_CTRL2_TUNED_CLK)) {
+		mmio_write_16(mmc->base + SDH_HOST_CONTROL2, ctrl2 &
+					~(SDH_CTRL2_EXEC_TUNING | SDH_CTRL2_TUNED_CLK));
+		sdh_reset(mmc, SDH_RESET_CMD);
+		sdh_reset(mmc, SDH_RESET_DATA);
+		return -EIO;
+	}
+	return 0;
+}
+
+/* CMD6 group 1 function 1: SD high speed */
+static int sd_set_high_speed(struct mmc *mmc)
+{
+	int err;
+
+	if (!(mmc->caps & MMC_CAP_SD_HIGHSPEED))
+		return -ENOTSUP;
+
+	err = sd_switch(mmc, 0, 0, 1, sdh_status_buf);
+	if (err)
+		return err;
+	if (!(sdh_status_buf[13] & 0x2))
+		return -ENOTSUP;
+
+	err = sd_switch(mmc, 1, 0, 1, sdh_status_buf);
+	if (err)
+		return err;
+	if ((sdh_status_buf[16] & 0xf) != 1)
+		return -EIO;
+
+	return 0;
+}
+
+/*
+ * Pick the fastest eMMC timing allowed by both EXT_CSD and the board:
+ * HS200 (with tuning), then HS52 with optional DDR, then legacy.
+ */
+static void mmc_set_bus_mode(struct mmc *mmc)
+{
+	unsigned char card_type;
+
+	if (mmc_read_ext_csd(mmc) != 0) {
+		WARN("eMMC EXT_CSD read failed\n");
+		sdh_set_clock(mmc, MMC_FREQ_LEGACY);
+		return;
+	}
+	card_type = sdh_status_buf[EXT_CSD_CARD_TYPE];
+
+	if ((mmc->caps & MMC_CAP_HS200) && (mmc->bus_width > 1) &&
+	    (card_type & EXT_CSD_CARD_TYPE_HS200_1_8V)) {
+		if (mmc_switch(mmc, EXT_CSD_HS_TIMING,
+			       EXT_CSD_TIMING_HS200) == 0) {
+			sdh_set_timing(mmc, MMC_TIMING_MMC_HS200);
+			sdh_set_clock(mmc, MMC_FREQ_HS200);
+			if (sdh_execute_tuning(mmc) == 0)
+				return;
+
+			/*
+			 * The card is still in HS200. Slow the clock down so
+			 * CMD6 gets through untuned, put the card back to HS
+			 * timing, and only then drop the host timing.
+			 */
+			WARN("eMMC HS200 tuning failed\n");
+			sdh_set_clock(mmc, MMC_FREQ_LEGACY);
+			mmc_switch(mmc, EXT_CSD_HS_TIMING, EXT_CSD_TIMING_HS);
+			sdh_set_timing(mmc, MMC_TIMING_LEGACY);
+			sdh_set_clock(mmc, MMC_FREQ_LEGACY);
+		}
+	}
+
+	if ((mmc->caps & MMC_CAP_MMC_HIGHSPEED) &&
+	    (card_type & EXT_CSD_CARD_TYPE_HS_52)) {
+		if (mmc_switch(mmc, EXT_CSD_HS_TIMING,
+			       EXT_CSD_TIMING_HS) == 0) {
+			sdh_set_timing(mmc, MMC_TIMING_MMC_HS);
+			sdh_set_clock(mmc, MMC_FREQ_HS);
+
+			if ((mmc->caps & MMC_CAP_DDR) && (mmc->bus_width > 1) &&
+			    (card_type & EXT_CSD_CARD_TYPE_DDR_1_8V) &&
+			    (mmc_switch(mmc, EXT_CSD_BUS_WIDTH,
+					(mmc->bus_width == 8) ?
+					EXT_CSD_DDR_BUS_WIDTH_8 :
+					EXT_CSD_DDR_BUS_WIDTH_4) == 0)) {
+				sdh_set_timing(mmc, MMC_TIMING_MMC_DDR52);
+				sdh_set_clock(mmc, MMC_FREQ_HS);
+			}
+			return;
+		}
+	}
+
+	mmc_switch(mmc, EXT_CSD_HS_TIMING, EXT_CSD_TIMING_LEGACY);
+	sdh_set_timing(mmc, MMC_TIMING_LEGACY);
+	sdh_set_clock(mmc, MMC_FREQ_LEGACY);
+}
+
+static void sd_set_bus_mode(struct mmc *mmc)
+{
+	if ((mmc->version == SD_VERSION_2) && (sd_set_high_speed(mmc) == 0)) {
+		sdh_set_timing(mmc, MMC_TIMING_SD_HS);
+		sdh_set_clock(mmc, SD_FREQ_HS);
+	} else {
+		sdh_set_timing(mmc, MMC_TIMING_LEGACY);
+		sdh_set_clock(mmc, SD_FREQ_LEGACY);
+	}
 }
 
 
 static int ma35d1_sdhc_hw_init(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
-	int err;
 
 	volatile int timeout;
 
 	sdh_reset(mmc, SDH_RESET_ALL);
 	sdh_set_power(mmc);
 
+	mmc->adma2 = (mmio_read_32(mmc->base + SDH_CAPABILITIES) &
+		      SDH_CAP_ADMA2) != 0;
+
 	/* Enable only interrupts served by the SD controller */
 	mmio_write_32(mmc->base +
 				 SDH_INT_ENABLE,
@@ -615,21 +992,16 @@ static int ma35d1_sdhc_hw_init(struct mmc *mmc)
 		mmc->rca = cmd.response[0] & 0xffff0000;
 
 	sdh_select_card(mmc);
-	if (mmc->version == SD_VERSION_2) {
+	if (mmc->version == SD_VERSION_2)
 		sd_set_clear_card_detect(mmc);
-		{
-			unsigned char *switch_status[64];
-
-			err = sd_switch(mmc, 1, 0, 0,
-					(unsigned char *)switch_status);
-			if (err) {
-				ERROR("sd_switch failed\n");
-				return err;
-			}
-		}
-	}
-	/* 12MHz */
-	sdh_set_clock(mmc, 20000000);
+
+	if (mmc->version == MMC_VERSION)
+		mmc_set_bus_mode(mmc);
+	else
+		sd_set_bus_mode(mmc);
+
+	INFO("SDH: timing %d, %d-bit bus\n", mmc->timing,
+	     (mmc->version == MMC_VERSION) ? mmc->bus_width : 4);
 
 	return 0;
 }
@@ -662,6 +1034,17 @@ static void ma35d1_sdhc_setup(struct mmc *mmc)
 
 	mmc->offset = fdt_read_uint32_default(fdt, node, "mmc-image-offset", 0);
 	mmc->bus_width = fdt_read_uint32_default(fdt, node, "bus-width", 1);
+	mmc->max_freq = fdt_read_uint32_default(fdt, node, "max-frequency", 0);
+
+	mmc->caps = 0;
+	if (fdt_getprop(fdt, node, "cap-sd-highspeed", NULL) != NULL)
+		mmc->caps |= MMC_CAP_SD_HIGHSPEED;
+	if (fdt_getprop(fdt, node, "cap-mmc-highspeed", NULL) != NULL)
+		mmc->caps |= MMC_CAP_MMC_HIGHSPEED;
+	if (fdt_getprop(fdt, node, "mmc-ddr-1_8v", NULL) != NULL)
+		mmc->caps |= MMC_CAP_DDR;
+	if (fdt_getprop(fdt, node, "mmc-hs200-1_8v", NULL) != NULL)
+		mmc->caps |= MMC_CAP_HS200;
 
 	ma35d1_sdhc_hw_init(mmc);
 }
@@ -669,11 +1052,18 @@ static void ma35d1_sdhc_setup(struct mmc *mmc)
 static size_t ma35d1_sdhc_read(int lba, uintptr_t buf, size_t size)
 {
 	size_t count = 0;
+	size_t chunk;
 
 	inv_dcache_range(buf, size);
 
-	if (sdh_read_blocks(&ma35d1_mmc, lba, (void *)buf, size/512) == 0)
-		count = size;
+	/* one command per descriptor table worth of data */
+	while (count < size) {
+		chunk = MIN(size - count, (size_t)SDH_ADMA2_MAX_XFER);
+		if (sdh_read_blocks(&ma35d1_mmc, lba + (count / 512),
+				    (void *)(buf + count), chunk / 512) != 0)
+			break;
+		count += chunk;
+	}
 
 	inv_dcache_range(buf, size);
 
@@ -686,6 +1076,7 @@ static struct io_block_dev_spec sdhc_dev_spec = {
 		.read = ma35d1_sdhc_read,
 	},
 	.block_size = 512,
+	.flags = IO_BLOCK_FLAG_DIRECT_READ,
 };
 
 int ma35d1_sdhc_init(struct io_block_dev_spec **block_dev_spec,
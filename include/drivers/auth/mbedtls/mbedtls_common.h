@@ -9,4 +9,16 @@
 
 void mbedtls_init(void);
 
+#if TF_MBEDTLS_HEAP_ARENA
+void mbedtls_heap_step_begin(void);
+void mbedtls_heap_step_end(const char *step);
+#else
+static inline void mbedtls_heap_step_begin(void)
+{
+}
+static inline void mbedtls_heap_step_end(const char *step)
+{
+}
+#endif
+
 #endif /* MBEDTLS_COMMON_H */
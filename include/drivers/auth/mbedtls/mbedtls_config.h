@@ -108,12 +108,14 @@
 #endif
 
 /*
- * Determine Mbed TLS heap size
+ * Determine Mbed TLS heap size, unless the platform provides its own
  * 13312 = 13*1024
  * 11264 = 11*1024
  * 7168  = 7*1024
  */
-#if TF_MBEDTLS_USE_ECDSA
+#if defined(TF_MBEDTLS_HEAP_SIZE)
+/* Set by the platform makefile */
+#elif TF_MBEDTLS_USE_ECDSA
 #define TF_MBEDTLS_HEAP_SIZE		U(13312)
 #elif TF_MBEDTLS_USE_RSA
 #if TF_MBEDTLS_KEY_SIZE <= 2048
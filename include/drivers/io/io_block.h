@@ -8,17 +8,36 @@
 #define IO_BLOCK_H
 
 #include <drivers/io/io_storage.h>
+#include <lib/utils_def.h>
 
-/* block devices ops */
+/*
+ * block devices ops
+ *
+ * read_done is optional. When set it is called every time a chunk of data
+ * has landed in the caller's buffer, so a platform can process an image
+ * (e.g. hash it) while the rest is still being read.
+ */
 typedef struct io_block_ops {
 	size_t	(*read)(int lba, uintptr_t buf, size_t size);
 	size_t	(*write)(int lba, const uintptr_t buf, size_t size);
+	void	(*read_done)(uintptr_t buf, size_t size);
 } io_block_ops_t;
 
+/*
+ * Block device capability flags
+ *
+ * IO_BLOCK_FLAG_DIRECT_READ: ops.read() can transfer whole blocks into any
+ * cache line aligned buffer, so block aligned parts of a read request are
+ * read straight into the caller buffer instead of going through the bounce
+ * buffer.
+ */
+#define IO_BLOCK_FLAG_DIRECT_READ	U(1)
+
 typedef struct io_block_dev_spec {
 	io_block_spec_t	buffer;
 	io_block_ops_t	ops;
 	size_t		block_size;
+	unsigned int	flags;
 } io_block_dev_spec_t;
 
 struct io_dev_connector;
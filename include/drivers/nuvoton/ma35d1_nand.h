@@ -97,6 +97,10 @@
 /* NAND commands */
 #define NAND_CMD_READ_1ST		0x00U
 #define NAND_CMD_READ_2ND		0x30U
+#define NAND_CMD_READ_CACHE_SEQ		0x31U
+#define NAND_CMD_READ_CACHE_END		0x3FU
+#define NAND_CMD_RNDOUT			0x05U
+#define NAND_CMD_RNDOUT_START		0xE0U
 #define NAND_CMD_STATUS			0x70U
 #define NAND_CMD_RESET			0xFFU
 
@@ -67,11 +67,15 @@ enum {
 	VOL_3_30 = 330
 };
 
-static volatile int pmic_state[3]={0, VOL_1_20 /*CPU*/, VOL_3_30 /*SD*/};
-static volatile int pmicIsInit=0;
-static volatile unsigned long pmic_clk;
+extern unsigned long pmic_clk;
+
+typedef struct {
+	unsigned char reg;
+	unsigned char val;
+} pmic_reg_t;
 
 int ma35d1_set_pmic(int type, int vol);
 int ma35d1_get_pmic(int type);
+int ma35d1_pmic_write_regs(const pmic_reg_t *regs, unsigned int num);
 
 #endif /* MA35D1_PMIC_H */
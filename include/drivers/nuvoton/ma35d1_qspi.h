@@ -22,6 +22,48 @@
 #define     REG_QSPI0_TX         (QSPI0_BASE+0x20)  /*!< SPI Data Transmit Register */
 #define     REG_QSPI0_RX         (QSPI0_BASE+0x30)  /*!< SPI Data Receive Register */
 
+/* QSPI0 STATUS */
+#define     QSPI_STATUS_RXCNT_POS   24
+#define     QSPI_STATUS_RXCNT_MSK   0x0F000000
+
+#define     QSPI_FIFO_DEPTH      4      /* words in flight in the data phase */
+
+/* QSPI0 PDMACTL */
+#define     QSPI_PDMACTL_TXPDMAEN   0x1
+#define     QSPI_PDMACTL_RXPDMAEN   0x2
+#define     QSPI_PDMACTL_PDMARST    0x4
+
+/*-----------------------------------------------------------------------------
+ * PDMA0 Register's Definition
+ *---------------------------------------------------------------------------*/
+#define    PDMA0_BASE       0x40080000  /*!< Peripheral DMA 0 */
+
+#define     REG_PDMA0_DSCT_CTL(ch)   (PDMA0_BASE+0x00+(ch)*0x10)  /*!< Descriptor Table Control Register */
+#define     REG_PDMA0_DSCT_SA(ch)    (PDMA0_BASE+0x04+(ch)*0x10)  /*!< Source Address Register */
+#define     REG_PDMA0_DSCT_DA(ch)    (PDMA0_BASE+0x08+(ch)*0x10)  /*!< Destination Address Register */
+#define     REG_PDMA0_CHCTL          (PDMA0_BASE+0x400)  /*!< PDMA Channel Control Register */
+#define     REG_PDMA0_ABTSTS         (PDMA0_BASE+0x420)  /*!< PDMA Channel Read/Write Target Abort Flag Register */
+#define     REG_PDMA0_TDSTS          (PDMA0_BASE+0x424)  /*!< PDMA Channel Transfer Done Flag Register */
+#define     REG_PDMA0_CHRST          (PDMA0_BASE+0x460)  /*!< PDMA Channel Reset Register */
+#define     REG_PDMA0_REQSEL0_3      (PDMA0_BASE+0x480)  /*!< PDMA Request Source Select Register 0 */
+
+/* DSCT_CTL */
+#define PDMA_OP_BASIC           0x00000001
+#define PDMA_REQ_SINGLE         0x00000004
+#define PDMA_TBINTDIS           0x00000080
+#define PDMA_SAR_FIX            0x00000300
+#define PDMA_DAR_FIX            0x00000C00
+#define PDMA_WIDTH_32           0x00002000
+#define PDMA_DSCT_CTL_TXCNT_POS 16
+#define PDMA_MAX_TXCNT          0x10000U
+
+/* PDMA0 channels used for the QSPI0 data phase */
+#define PDMA_QSPI_TX_CH         0
+#define PDMA_QSPI_RX_CH         1
+#define PDMA_QSPI_CH_MSK        ((1 << PDMA_QSPI_TX_CH) | (1 << PDMA_QSPI_RX_CH))
+
+#define QSPI_PDMA_TIMEOUT_US    100000
+
 
 /*-----------------------------------------------------------------------------
  * Define some constants
@@ -43,6 +85,18 @@
 #define CMD_READ_CONFIG             0x35
 #define CMD_READ_EVCR               0x65
 
+/* SPI-NAND */
+#define CMD_SPINAND_READ_CACHE_SEQ  0x31
+#define CMD_SPINAND_READ_CACHE_END  0x3f
+
+/* SPI-NAND configuration register (0xb0) */
+#define SPINAND_CFG_BUF             0x08    /* buffer read mode, 0: continuous read */
+
+/* SPI-NAND multi-page read modes, "spinand-seq-read" in the device tree */
+#define SPINAND_SEQ_READ_NONE           0   /* page read per page */
+#define SPINAND_SEQ_READ_CACHE          1   /* read page cache sequential 0x31/0x3f */
+#define SPINAND_SEQ_READ_CONTINUOUS     2   /* continuous read (BUF = 0) */
+
 
 #define     GPIO_BASE        0x40040000  /*!< GPIO Control */
 
@@ -73,6 +73,30 @@
 #define  SDH_CMD_RESP_SHORT      0x02
 #define  SDH_CMD_RESP_SHORT_BUSY 0x03
 
+#define  SDH_CAP_ADMA2           0x00080000
+
+#define  SDH_CTRL_4BITBUS        0x02
+#define  SDH_CTRL_HISPD          0x04
+#define  SDH_CTRL_8BITBUS        0x20
+#define  SDH_CTRL_DMA_MASK       0x18
+#define  SDH_CTRL_SDMA           0x00
+#define  SDH_CTRL_ADMA32         0x10
+
+#define  SDH_CTRL2_UHS_MASK      0x07
+#define  SDH_CTRL2_UHS_SDR104    0x03
+#define  SDH_CTRL2_UHS_DDR50     0x04
+#define  SDH_CTRL2_VDD_180       0x08
+#define  SDH_CTRL2_EXEC_TUNING   0x40
+#define  SDH_CTRL2_TUNED_CLK     0x80
+
+#define  SDH_INT_DATA_AVAIL      0x20
+
+/* ADMA2 descriptor attributes */
+#define  SDH_ADMA2_VALID         0x01
+#define  SDH_ADMA2_END           0x02
+#define  SDH_ADMA2_INT           0x04
+#define  SDH_ADMA2_ACT_TRAN      0x20
+
 
 /* MMC command */
 #define MMC_CMD_GO_IDLE_STATE           0
@@ -115,6 +139,47 @@
 #define SD_CMD_APP_SEND_OP_COND         41
 #define SD_CMD_APP_SEND_SCR             51
 
+/* card status (R1) */
+#define MMC_STATUS_SWITCH_ERROR         (1 << 7)
+#define MMC_STATUS_READY_FOR_DATA       (1 << 8)
+#define MMC_STATUS_CURR_STATE(x)        (((x) >> 9) & 0xf)
+#define MMC_STATE_TRAN                  4
+
+/* EXT_CSD fields */
+#define EXT_CSD_BUS_WIDTH               183
+#define EXT_CSD_HS_TIMING               185
+#define EXT_CSD_CARD_TYPE               196
+
+#define EXT_CSD_CARD_TYPE_HS_26         (1 << 0)
+#define EXT_CSD_CARD_TYPE_HS_52         (1 << 1)
+#define EXT_CSD_CARD_TYPE_DDR_1_8V      (1 << 2)
+#define EXT_CSD_CARD_TYPE_HS200_1_8V    (1 << 4)
+
+#define EXT_CSD_BUS_WIDTH_1             0
+#define EXT_CSD_BUS_WIDTH_4             1
+#define EXT_CSD_BUS_WIDTH_8             2
+#define EXT_CSD_DDR_BUS_WIDTH_4         5
+#define EXT_CSD_DDR_BUS_WIDTH_8         6
+
+#define EXT_CSD_TIMING_LEGACY           0
+#define EXT_CSD_TIMING_HS               1
+#define EXT_CSD_TIMING_HS200            2
+
+#define MMC_SWITCH_MODE_WRITE_BYTE      3
+
+/* bus timings */
+#define MMC_TIMING_LEGACY               0
+#define MMC_TIMING_SD_HS                1
+#define MMC_TIMING_MMC_HS               2
+#define MMC_TIMING_MMC_DDR52            3
+#define MMC_TIMING_MMC_HS200            4
+
+/* board capabilities, from the device tree */
+#define MMC_CAP_SD_HIGHSPEED            (1 << 0)
+#define MMC_CAP_MMC_HIGHSPEED           (1 << 1)
+#define MMC_CAP_DDR                     (1 << 2)
+#define MMC_CAP_HS200                   (1 << 3)
+
 /* MMC response */
 #define MMC_RSP_PRESENT (1 << 0)
 #define MMC_RSP_136     (1 << 1)        /* 136 bit response */
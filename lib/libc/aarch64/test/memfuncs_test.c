@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2021, Nuvoton Technology Corp. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test for lib/libc/aarch64/{memcpy,memmove,memset}.S. The routines
+ * are assembled with their symbols renamed to tfa_* so they do not clash
+ * with the host C library, and every result is compared against a byte
+ * loop over the whole buffer, so stray writes before or after the
+ * destination are caught as well.
+ *
+ * memset reads SCTLR_EL1 to decide whether DC ZVA is usable. That traps at
+ * EL0, so a SIGILL handler emulates the read with the value in
+ * sctlr_emul. Zero fills run once with M and C clear (no DC ZVA) and once
+ * with both set (DC ZVA, unless DCZID_EL0.DZP prohibits it).
+ */
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+void *tfa_memcpy(void *dst, const void *src, size_t len);
+void *tfa_memmove(void *dst, const void *src, size_t len);
+void *tfa_memset(void *dst, int val, size_t count);
+
+#define SCTLR_M_BIT		(1UL << 0)
+#define SCTLR_C_BIT		(1UL << 2)
+
+/* MRS Xt, SCTLR_EL1 */
+#define MRS_SCTLR_EL1		0xd5381000U
+#define MRS_RT_MASK		0x1fU
+
+#define MAX_ALIGN		16
+#define MAX_SMALL		300
+#define GUARD			64
+#define MAX_SHIFT		128
+#define BUF_SIZE		((2 * 1024 * 1024) + (2 * GUARD))
+
+static const size_t large_lens[] = {
+	1024, 4095, 4096, 4097, 65536 - 7, 65536 + 64, 1024 * 1024 + 13,
+};
+
+/* Overlap distances for memmove, used in both directions */
+static const size_t move_shifts[] = {
+	1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 128,
+};
+
+static const int set_vals[] = { 0x00, 0x5a, 0xff };
+
+static unsigned char *buf, *ref, *src_buf;
+static volatile unsigned long sctlr_emul;
+static volatile unsigned long sctlr_reads;
+static unsigned long cases;
+
+static void sigill_handler(int sig, siginfo_t *si, void *ctx)
+{
+	ucontext_t *uc = ctx;
+	uint32_t insn = *(const uint32_t *)uc->uc_mcontext.pc;
+	unsigned int rt = insn & MRS_RT_MASK;
+
+	(void)si;
+
+	if ((insn & ~MRS_RT_MASK) != MRS_SCTLR_EL1) {
+		fprintf(stderr, "unexpected SIGILL at %p (insn 0x%08x)\n",
+			(void *)uc->uc_mcontext.pc, insn);
+		signal(sig, SIG_DFL);
+		return;
+	}
+
+	if (rt != 31U)
+		uc->uc_mcontext.regs[rt] = sctlr_emul;
+	uc->uc_mcontext.pc += 4;
+	sctlr_reads++;
+}
+
+static unsigned long read_dczid(void)
+{
+	unsigned long dczid;
+
+	__asm__ volatile ("mrs %0, dczid_el0" : "=r" (dczid));
+	return dczid;
+}
+
+static void fill(unsigned char *p, size_t len, unsigned int seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		seed = seed * 1103515245U + 12345U;
+		p[i] = (unsigned char)(seed >> 16);
+	}
+}
+
+static void ref_copy(unsigned char *dst, const unsigned char *src, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		dst[i] = src[i];
+}
+
+static void ref_move(unsigned char *dst, const unsigned char *src, size_t len)
+{
+	size_t i;
+
+	if (dst <= src) {
+		for (i = 0; i < len; i++)
+			dst[i] = src[i];
+	} else {
+		for (i = len; i > 0; i--)
+			dst[i - 1] = src[i - 1];
+	}
+}
+
+static void ref_set(unsigned char *dst, int val, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		dst[i] = (unsigned char)val;
+}
+
+static void check(const char *name, size_t span, size_t dst_off,
+		  size_t src_off, size_t len, void *ret, void *dst)
+{
+	size_t i;
+
+	cases++;
+
+	if (ret != dst) {
+		printf("%s: dst_off %zu src_off %zu len %zu: returned %p, expected %p\n",
+		       name, dst_off, src_off, len, ret, dst);
+		exit(1);
+	}
+
+	for (i = 0; i < span; i++) {
+		if (buf[i] != ref[i]) {
+			printf("%s: dst_off %zu src_off %zu len %zu: byte %zu is 0x%02x, expected 0x%02x\n",
+			       name, dst_off, src_off, len, i, buf[i], ref[i]);
+			exit(1);
+		}
+	}
+}
+
+static void test_memcpy_one(size_t dst_off, size_t src_off, size_t len)
+{
+	size_t span = GUARD + dst_off + len + GUARD;
+	unsigned char *dst = buf + GUARD + dst_off;
+	unsigned char *src = src_buf + GUARD + src_off;
+	void *ret;
+
+	fill(buf, span, (unsigned int)(len + dst_off));
+	memcpy(ref, buf, span);
+	ref_copy(ref + GUARD + dst_off, src, len);
+
+	ret = tfa_memcpy(dst, src, len);
+	check("memcpy", span, dst_off, src_off, len, ret, dst);
+}
+
+static void test_memcpy(void)
+{
+	size_t d, s, len, i;
+
+	fill(src_buf, BUF_SIZE, 1U);
+
+	for (d = 0; d < MAX_ALIGN; d++)
+		for (s = 0; s < MAX_ALIGN; s++)
+			for (len = 0; len <= MAX_SMALL; len++)
+				test_memcpy_one(d, s, len);
+
+	for (i = 0; i < sizeof(large_lens) / sizeof(large_lens[0]); i++)
+		for (d = 0; d < MAX_ALIGN; d += 3)
+			for (s = 0; s < MAX_ALIGN; s += 5)
+				test_memcpy_one(d, s, large_lens[i]);
+}
+
+/*
+ * Move len bytes within buf from GUARD + MAX_SHIFT + off to the same
+ * position shifted by 'shift' (negative: dst below src).
+ */
+static void test_memmove_one(size_t off, long shift, size_t len)
+{
+	size_t base = GUARD + MAX_SHIFT + off;
+	size_t span = base + len + MAX_SHIFT + GUARD;
+	unsigned char *src = buf + base;
+	unsigned char *dst = buf + base + shift;
+	void *ret;
+
+	fill(buf, span, (unsigned int)(len * 7U + off));
+	memcpy(ref, buf, span);
+	ref_move(ref + base + shift, ref + base, len);
+
+	ret = tfa_memmove(dst, src, len);
+	check(shift > 0 ? "memmove up" : "memmove down", span,
+	      base + shift, base, len, ret, dst);
+}
+
+static void test_memmove(void)
+{
+	size_t off, len, i;
+	long shift;
+
+	for (i = 0; i < sizeof(move_shifts) / sizeof(move_shifts[0]); i++) {
+		shift = (long)move_shifts[i];
+		for (off = 0; off < MAX_ALIGN; off++) {
+			for (len = 0; len <= MAX_SMALL; len++) {
+				test_memmove_one(off, shift, len);
+				test_memmove_one(off, -shift, len);
+			}
+		}
+	}
+
+	/* dst == src, and disjoint buffers through the memcpy tail call */
+	for (off = 0; off < MAX_ALIGN; off++)
+		for (len = 0; len <= MAX_SMALL; len += 13)
+			test_memmove_one(off, 0, len);
+
+	for (i = 0; i < sizeof(large_lens) / sizeof(large_lens[0]); i++) {
+		if (large_lens[i] + 2 * MAX_SHIFT + 2 * GUARD + MAX_ALIGN > BUF_SIZE)
+			continue;
+		for (off = 0; off < MAX_ALIGN; off += 5) {
+			test_memmove_one(off, 1, large_lens[i]);
+			test_memmove_one(off, -1, large_lens[i]);
+			test_memmove_one(off, 64, large_lens[i]);
+			test_memmove_one(off, -64, large_lens[i]);
+		}
+	}
+}
+
+static void test_memset_one(size_t dst_off, int val, size_t len)
+{
+	size_t span = GUARD + dst_off + len + GUARD;
+	unsigned char *dst = buf + GUARD + dst_off;
+	void *ret;
+
+	fill(buf, span, (unsigned int)(len + dst_off + val));
+	memcpy(ref, buf, span);
+	ref_set(ref + GUARD + dst_off, val, len);
+
+	/* only the low byte of val counts */
+	ret = tfa_memset(dst, val | 0x1200, len);
+	check("memset", span, dst_off, 0, len, ret, dst);
+}
+
+static void test_memset_pass(void)
+{
+	size_t d, len, i, v;
+
+	for (v = 0; v < sizeof(set_vals) / sizeof(set_vals[0]); v++)
+		for (d = 0; d < MAX_ALIGN; d++)
+			for (len = 0; len <= MAX_SMALL; len++)
+				test_memset_one(d, set_vals[v], len);
+
+	/* zero fills around the DC ZVA thresholds and block sizes */
+	for (d = 0; d < MAX_ALIGN; d++) {
+		for (len = 256; len <= 1024 + 72; len += 8) {
+			test_memset_one(d, 0, len);
+			test_memset_one(d, 0, len + 1);
+			test_memset_one(d, 0, len + 7);
+		}
+	}
+
+	for (i = 0; i < sizeof(large_lens) / sizeof(large_lens[0]); i++) {
+		for (d = 0; d < MAX_ALIGN; d += 3) {
+			test_memset_one(d, 0, large_lens[i]);
+			test_memset_one(d, 0xa5, large_lens[i]);
+		}
+	}
+}
+
+static void test_memset(void)
+{
+	unsigned long dczid = read_dczid();
+
+	/* MMU off: no DC ZVA */
+	sctlr_emul = 0;
+	test_memset_pass();
+
+	/* MMU and cache on: DC ZVA for large zero fills */
+	sctlr_emul = SCTLR_M_BIT | SCTLR_C_BIT;
+	sctlr_reads = 0;
+	test_memset_pass();
+
+	if (sctlr_reads == 0) {
+		printf("memset: zero fills never reached the DC ZVA check\n");
+		exit(1);
+	}
+	if ((dczid & (1UL << 4)) != 0)
+		printf("memset: DCZID_EL0.DZP is set, DC ZVA path not exercised\n");
+	else
+		printf("memset: DC ZVA block size %lu bytes\n",
+		       4UL << (dczid & 0xfUL));
+}
+
+int main(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_sigaction = sigill_handler;
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGILL, &sa, NULL) != 0) {
+		perror("sigaction");
+		return 1;
+	}
+
+	/* src_buf is only read, buf is written, ref holds the expected bytes */
+	buf = malloc(BUF_SIZE);
+	ref = malloc(BUF_SIZE);
+	src_buf = malloc(BUF_SIZE);
+	if ((buf == NULL) || (ref == NULL) || (src_buf == NULL)) {
+		printf("out of memory\n");
+		return 1;
+	}
+
+	test_memcpy();
+	printf("memcpy: %lu cases passed\n", cases);
+
+	cases = 0;
+	test_memmove();
+	printf("memmove: %lu cases passed\n", cases);
+
+	cases = 0;
+	test_memset();
+	printf("memset: %lu cases passed\n", cases);
+
+	return 0;
+}
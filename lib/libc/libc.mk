@@ -10,10 +10,7 @@ LIBC_SRCS	:=	$(addprefix lib/libc/,		\
 			exit.c				\
 			memchr.c			\
 			memcmp.c			\
-			memcpy.c			\
-			memmove.c			\
 			memrchr.c			\
-			memset.c			\
 			printf.c			\
 			putchar.c			\
 			puts.c				\
@@ -31,5 +28,17 @@ LIBC_SRCS	+=	$(addprefix lib/libc/aarch64/,	\
 			setjmp.S)
 endif
 
+ifeq ($(ARCH)-$(LIBC_OPTIMIZED_MEMFUNCS),aarch64-1)
+LIBC_SRCS	+=	$(addprefix lib/libc/aarch64/,	\
+			memcpy.S			\
+			memmove.S			\
+			memset.S)
+else
+LIBC_SRCS	+=	$(addprefix lib/libc/,		\
+			memcpy.c			\
+			memmove.c			\
+			memset.c)
+endif
+
 INCLUDES	+=	-Iinclude/lib/libc		\
 			-Iinclude/lib/libc/$(ARCH)	\
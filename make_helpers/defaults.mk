@@ -166,6 +166,9 @@ NS_TIMER_SWITCH			:= 0
 # Include lib/libc in the final image
 OVERRIDE_LIBC			:= 0
 
+# Use the AArch64 assembly memcpy/memmove/memset in lib/libc
+LIBC_OPTIMIZED_MEMFUNCS		:= 0
+
 # Build PL011 UART driver in minimal generic UART mode
 PL011_GENERIC_UART		:= 0
 
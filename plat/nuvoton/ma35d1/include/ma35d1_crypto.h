@@ -62,6 +62,7 @@ extern "C"
 #define AES_CTL_STOP			(0x1 << 1)
 #define AES_CTL_KEYSZ_OFFSET		2
 #define AES_CTL_KEYSZ_MASK		(0x3 << 2)
+#define AES_CTL_DMALAST_OFFSET		5
 #define AES_CTL_DMALAST			(0x1 << 5)
 #define AES_CTL_DMACSCAD		(0x1 << 6)
 #define AES_CTL_DMAEN			(0x1 << 7)
@@ -209,6 +210,8 @@ extern "C"
 #define ECC_KSXY_RSSRCY_MASK		(0x3 << 14)
 
 
+#define PRNG_KEY_SIZE_256       6UL     /*!< PRNG generate 256-bit random key        \hideinitializer */
+
 #define AES_KEY_SIZE_128        0UL     /*!< AES select 128-bit key length           \hideinitializer */
 #define AES_KEY_SIZE_192        1UL     /*!< AES select 192-bit key length           \hideinitializer */
 #define AES_KEY_SIZE_256        2UL     /*!< AES select 256-bit key length           \hideinitializer */
@@ -250,6 +253,10 @@ extern "C"
 #define CRYPTO_DMA_CONTINUE     0x6UL   /*!< Do continuous encrypt/decrypt in DMA cascade \hideinitializer */
 #define CRYPTO_DMA_LAST         0x7UL   /*!< Do last encrypt/decrypt in DMA cascade          \hideinitializer */
 
+#define SHA_TIMEOUT_US          1000000UL /*!< SHA DMA completion timeout, 1 second */
+#define AES_TIMEOUT_US          1000000UL /*!< AES DMA completion timeout, 1 second */
+#define PRNG_TIMEOUT_US         10000UL   /*!< PRNG key generation timeout, 10 ms */
+
 
 #define RSA_MAX_KLEN            (4096)
 #define RSA_KBUF_HLEN           (RSA_MAX_KLEN/4 + 8)
@@ -423,10 +430,27 @@ extern "C"
 /*---------------------------------------------------------------------------------------------------------*/
 /*  Functions                                                                                      */
 /*---------------------------------------------------------------------------------------------------------*/
+/* ECC register banks are 18 words wide; P-256/P-384 operands use 32/48 bytes */
+#define ECC_LIMBS		18
+#define ECC_P256_BYTES		32
+#define ECC_P384_BYTES		48
+
 void Reg2Hex(int count, unsigned int *reg, char output[]);
+void hex_to_string(unsigned char *hex, int count, char *str);
+void ECC_Load_Bin(uintptr_t reg, const unsigned char *bin, int len);
 void SHA_Open(unsigned int u32OpMode, unsigned int u32SwapType, unsigned int hmac_key_len);
 void SHA_Start(unsigned int u32DMAMode);
 void SHA_SetDMATransfer(unsigned int u32SrcAddr, unsigned int u32TransCnt);
 void SHA_Read(unsigned int u32Digest[]);
-int ECC_VerifySignature_KS(char *message, int x_ksnum, int y_ksnum, char *R, char *S);
+int SHA_Wait(void);
+void AES_SetDMATransfer(unsigned int u32SrcAddr, unsigned int u32DstAddr,
+			unsigned int u32TransCnt);
+void AES_Start(unsigned int u32DMAMode);
+int AES_Wait(void);
+int PRNG_Generate256(int reseed, unsigned int u32RandKey[8]);
+int ECC_VerifySignature_KS(const unsigned char *message, int x_ksnum, int y_ksnum,
+			   const unsigned char *R, const unsigned char *S);
+int ECC_VerifySignature(int key_len, const unsigned char *message, int msg_len,
+			const unsigned char *Qx, const unsigned char *Qy,
+			const unsigned char *R, const unsigned char *S);
 #endif /* MA35D1_CRYPTO_H */
@@ -14,6 +14,9 @@
 #define SIP_LOW_SPEED			0xC200000B
 #define SIP_CHIP_RESET			0xC200000D
 #define SIP_SVC_VERSION			0xC200000F
+#define SIP_SVC_RNG			0xC2000010
+#define SIP_SVC_RNG_BATCH		0xC2000011
+#define SIP_SVC_SET_OPP			0xC2000012
 
 /* MA35D1 SiP Service Calls PLL setting */
 #define NVT_SIP_SVC_EPLL_DIV_BY_2	0x2
@@ -21,6 +24,10 @@
 #define NVT_SIP_SVC_EPLL_DIV_BY_8	0x8
 #define NVT_SIP_SVC_EPLL_RESTORE	0xF
 
+/* Random words returned in registers, and largest batch request in bytes */
+#define NVT_SIP_SVC_RNG_MAX_WORDS	3
+#define NVT_SIP_SVC_RNG_BATCH_MAX	0x1000
+
 /* MA35D1 SiP Service Calls version numbers */
 #define NVT_SIP_SVC_VERSION_MAJOR	0x0
 #define NVT_SIP_SVC_VERSION_MINOR	0x1
@@ -30,7 +37,8 @@
 
 enum {
 	RK_SIP_E_SUCCESS = 0,
-	RK_SIP_E_INVALID_PARAM = -1
+	RK_SIP_E_INVALID_PARAM = -1,
+	RK_SIP_E_NOT_AVAILABLE = -2
 };
 
 #endif /* MA35D1_SIP_SVC_H */
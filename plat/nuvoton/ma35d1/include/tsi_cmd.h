@@ -96,6 +96,7 @@
 #define ST_KS_FULL              0x81    /* Key Store full                               */
 #define ST_WHC_TX_BUSY          0xd1    /* All TX channel of Wormhole are busy          */
 #define ST_CMD_ACK_TIME_OUT     0xd2    /* TSI does not ack command in time limit       */
+#define ST_CMD_PENDING          0xd3    /* Command sent, TSI has not acked it yet       */
 
 typedef struct tsi_cmd_t {
 	uint32_t	cmd[4];
@@ -107,6 +108,7 @@ typedef struct tsi_cmd_t {
 	uint32_t	caddr_src;	/* current data source address               */
 	uint32_t	caddr_dst;	/* current data destination address          */
 	uint32_t	remain_len;	/* remaining data length                     */
+	int		state;		/* TREQ_ST_XXX, for tsi_submit() requests    */
 } TSI_REQ_T;
 
 typedef struct tsi_image_info {
@@ -166,6 +168,9 @@ typedef enum {
 #define TSI_CMD_WORD0(cc, sc, sid)	((cc<<24)|(sc<<16)|sid)
 
 
+/* Commands that may wait for their ACK at the same time, one per WHC channel */
+#define TSI_MAX_INFLIGHT            4
+
 #define CMD_TIME_OUT_1S             100     /* general time-out 1 seconds */
 #define CMD_TIME_OUT_2S             200     /* general time-out 2 seconds */
 #define CMD_TIME_OUT_3S             300     /* general time-out 3 seconds */
@@ -176,6 +181,9 @@ typedef enum {
 #define SEL_KEY_FROM_KS_OTP         0x5
 
 
+#define PRNG_SEED_FROM_TRNG         0x0
+#define PRNG_SEED_FROM_USER         0x1
+
 #define ECC_KEY_SEL_TRNG            0x0
 #define ECC_KEY_SEL_KS_OTP          0x1
 #define ECC_KEY_SEL_KS_SRAM         0x2
@@ -186,6 +194,12 @@ typedef enum {
 #define RSA_KEY_SEL_USER            0x3
 
 
+int tsi_submit(TSI_REQ_T *req);
+int tsi_poll(TSI_REQ_T *req);
+int tsi_wait(TSI_REQ_T *req, int time_out);
+void tsi_cancel(TSI_REQ_T *req);
+void tsi_process_acks(void);
+
 int TSI_Sync(void);
 int TSI_Get_Version(uint32_t *ver_code);
 int TSI_Reset(void);
@@ -193,17 +207,25 @@ int TSI_Config_UART(uint32_t line, uint32_t baud);
 int TSI_Set_Clock(uint32_t pllctl);
 int TSI_Open_Session(int class_code, int *session_id);
 int TSI_Close_Session(int class_code, int session_id);
+int TSI_TRNG_Init(int method, uint32_t pers_str_addr);
+int TSI_TRNG_Gen_Random(uint32_t wcnt, uint32_t dest_addr);
+int TSI_PRNG_ReSeed(int seed_src, uint32_t seed);
+int TSI_PRNG_Gen_Random_Mass(uint32_t wcnt, uint32_t dest_addr);
 int TSI_AES_Set_Mode(int sid, int kinswap, int koutswap, int inswap, int outswap,
 		int sm4en, int encrypt, int mode, int keysz, int ks, int ks_num);
 int TSI_AES_Set_IV(int sid, uint32_t iv_addr);
 int TSI_AES_Set_Key(int sid, int keysz, uint32_t key_addr);
 int TSI_AES_Run(int sid, int is_last, int data_cnt, uint32_t src_addr,
 		uint32_t dest_addr);
+int TSI_AES_Run_Async(TSI_REQ_T *req, int sid, int is_last, int data_cnt,
+		uint32_t src_addr, uint32_t dest_addr);
 int TSI_AES_GCM_Run(int sid, int is_last, int data_cnt, uint32_t param_addr);
 int TSI_Access_Feedback(int sid, int rw, int wcnt, uint32_t fdbck_addr);
 int TSI_SHA_Start(int sid, int inswap, int outswap, int mode_sel, int hmac,
 		int mode, int keylen, int ks, int ks_num);
 int TSI_SHA_Update(int sid, int data_cnt, uint32_t src_addr);
+int TSI_SHA_Update_Async(TSI_REQ_T *req, int sid, int data_cnt,
+		uint32_t src_addr);
 int TSI_SHA_Finish(int sid, int wcnt, int data_cnt, uint32_t src_addr,
 		uint32_t dest_addr);
 int TSI_SHA_All_At_Once(int inswap, int outswap, int mode_sel, int mode,
@@ -5,6 +5,7 @@
  */
 
 #include <assert.h>
+#include <errno.h>
 
 #include <drivers/arm/sp804_delay_timer.h>
 #include <common/desc_image_load.h>
@@ -23,29 +24,14 @@
 #define SYS_BASE 0x40460000
 #define CA35WRBADR2 0x48
 
-#if FIP_DE_AES
-static __inline unsigned int Swap32(unsigned int val)
+void ma35d1_crypto_engine_init(void)
 {
-	return (val<<24) | ((val<<8)&0xff0000) | ((val>>8)&0xff00) | (val>>24);
-}
+	static int engine_ready;
 
+	if (engine_ready)
+		return;
 
-int ma35d1_fip_verify(uintptr_t base, size_t size) {
-	int j, k;
-	IMAGE_INFO_T *image_info;
-	unsigned int shaDigest[8], tmpbuf[8], *ptr;
-	unsigned char image[256];
-	unsigned int volatile u32SysCfg;
-	char *param = (char *)(TSI_PARAM_BASE);
-
-	if (size <= 0)
-		return 0;
-
-	image_info = (IMAGE_INFO_T *)image;
-	memcpy(image,(unsigned char *)base+size-sizeof(IMAGE_INFO_T),sizeof(IMAGE_INFO_T));
-	u32SysCfg = mmio_read_32(SYS_CHIPCFG);
-	if ((u32SysCfg & 0x100) == 0x000)       /* 0: TSI; 1: crypto */
-	{
+	if (ma35d1_use_tsi()) {
 		/* Enable whc0 clock */
 		mmio_write_32(CLK_SYSCLK1, (mmio_read_32(CLK_SYSCLK1) | 0x10));
 		/* connect with TSI */
@@ -57,7 +43,335 @@ int ma35d1_fip_verify(uintptr_t base, size_t size) {
 				break;
 			}
 		}
-		if (TSI_run_sha(	1,                          /* inswap        */
+	} else {
+		/* initial crypto engine and ks clock */
+		mmio_write_32((TSI_CLK_BASE+0x04),
+			    (mmio_read_32(TSI_CLK_BASE+0x04) | 0x5000));
+
+		/* Init KeyStore */
+		/* KS INIT(KS_CTL[8]) + START(KS_CTL[0]) */
+		mmio_write_32(KS_BASE+0x00, 0x101);
+		while ((mmio_read_32(KS_BASE+0x08) & 0x80) == 0)
+			;   /* wait for INITDONE(KS_STS[7]) set */
+		while (mmio_read_32(KS_BASE+0x08) & 0x4)
+			;      /* wait for BUSY(KS_STS[2]) cleared */
+	}
+	engine_ready = 1;
+}
+
+#if FIP_DE_AES
+/*
+ * Decrypt-behind-hash. FIP images are AES-256-CFB encrypted with a zero
+ * IV and the signed digest covers the ciphertext, so each region is
+ * decrypted in place right after the hash stream below has consumed it.
+ * The CRYPTO AES DMA cascade carries the CFB feedback between chunks; the
+ * TSI keeps it inside the AES session for every run that is not the last.
+ * Either way a chunk is only waited for once the next one has been read.
+ * If the hash stream drops after a chunk has been decrypted, the image in
+ * DRAM no longer matches the signed ciphertext, and
+ * bl2_plat_handle_post_image_load() reads it again from storage.
+ *
+ * With TRUSTED_BOARD_BOOT the generic image authentication hashes the
+ * loaded image after io has finished, and the certificate covers the
+ * ciphertext too, so nothing may be decrypted before that. The stream is
+ * then not started and ma35d1_fip_deaes() decrypts the whole image from
+ * bl2_plat_handle_post_image_load(), which runs after authentication.
+ */
+static struct {
+	int active;
+	int tsi;
+	int sid;
+	int started;
+	int broken;		/* part of the image is plaintext already */
+	uintptr_t next;		/* first byte not yet decrypted */
+	uintptr_t pending;	/* decrypt in flight on [pending, next) */
+	TSI_REQ_T req;
+} fip_aes;
+
+static int ma35d1_fip_aes_open(uintptr_t base)
+{
+	volatile unsigned char *param = (volatile unsigned char *)TSI_PARAM_BASE;
+	int j;
+
+	fip_aes.tsi = ma35d1_use_tsi();
+	fip_aes.started = 0;
+	fip_aes.broken = 0;
+	fip_aes.next = base;
+	fip_aes.pending = 0;
+
+	if (fip_aes.tsi) {
+		if (TSI_Open_Session(C_CODE_AES, &fip_aes.sid) != 0)
+			return 1;
+		for (j = 0; j < 32; j++)
+			*(param+j) = 0;
+		flush_dcache_range(TSI_PARAM_BASE, 32);
+		if ((TSI_AES_Set_IV(fip_aes.sid, (unsigned int)TSI_PARAM_BASE) != 0) ||
+		    (TSI_AES_Set_Mode(fip_aes.sid, 0, 0, 1, 1, 0, 0, AES_MODE_CFB,
+				      AES_KEY_SIZE_256, 5, 8) != 0)) {
+			TSI_Close_Session(C_CODE_AES, fip_aes.sid);
+			return 1;
+		}
+	} else {
+		/* AES, channel 0, AES decode, CFB mode, key 256, in/out swap */
+		mmio_write_32(AES_IV(0), 0);
+		mmio_write_32(AES_IV(1), 0);
+		mmio_write_32(AES_IV(2), 0);
+		mmio_write_32(AES_IV(3), 0);
+
+		/* key 8 from KS_OTP */
+		mmio_write_32(AES_KSCTL, (0x2 << AES_KSCTL_RSSRC_OFFSET) |
+			      AES_KSCTL_RSRC | 8);
+		mmio_write_32(AES_CTL, (AES_MODE_CFB << AES_CTL_OPMODE_OFFSET) |
+			      (AES_KEY_SIZE_256 << AES_CTL_KEYSZ_OFFSET) |
+			      AES_CTL_INSWAP | AES_CTL_OUTSWAP);
+	}
+	fip_aes.active = 1;
+	return 0;
+}
+
+/* Complete the decrypt started by the previous ma35d1_fip_aes_feed() */
+static int ma35d1_fip_aes_wait(void)
+{
+	int ret;
+
+	if (fip_aes.pending == 0)
+		return 0;
+
+	if (fip_aes.tsi) {
+		ret = tsi_wait(&fip_aes.req, CMD_TIME_OUT_2S);
+	} else {
+		ret = AES_Wait();
+		if (ret != 0)
+			mmio_write_32(AES_CTL, mmio_read_32(AES_CTL) | AES_CTL_STOP);
+	}
+	/* the DMA wrote behind the cache */
+	inv_dcache_range(fip_aes.pending, fip_aes.next - fip_aes.pending);
+	fip_aes.pending = 0;
+	return ret;
+}
+
+static void ma35d1_fip_aes_abort(void)
+{
+	if (!fip_aes.active)
+		return;
+
+	(void)ma35d1_fip_aes_wait();
+	if (fip_aes.tsi)
+		TSI_Close_Session(C_CODE_AES, fip_aes.sid);
+	fip_aes.broken = fip_aes.started;
+	fip_aes.active = 0;
+}
+
+/* Decrypt [next, next + len) in place, the data is clean in DRAM */
+static int ma35d1_fip_aes_feed(size_t len, int last)
+{
+	int ret;
+
+	ret = ma35d1_fip_aes_wait();
+	if (ret != 0)
+		return ret;
+
+	if (fip_aes.tsi) {
+		ret = TSI_AES_Run_Async(&fip_aes.req, fip_aes.sid, last, len,
+					fip_aes.next, fip_aes.next);
+		if (ret != 0)
+			return ret;
+	} else {
+		AES_SetDMATransfer(fip_aes.next, fip_aes.next, len);
+		if (last)
+			AES_Start(fip_aes.started ? CRYPTO_DMA_LAST :
+				  CRYPTO_DMA_ONE_SHOT);
+		else
+			AES_Start(fip_aes.started ? CRYPTO_DMA_CONTINUE :
+				  CRYPTO_DMA_FIRST);
+	}
+
+	fip_aes.started = 1;
+	fip_aes.pending = fip_aes.next;
+	fip_aes.next += len;
+	if (last)
+		ret = ma35d1_fip_aes_wait();
+	return ret;
+}
+
+/*
+ * Hash-while-load. Between bl2_plat_handle_pre_image_load() and the
+ * post-load verify, io_block reports every chunk that lands in the image
+ * buffer and the SHA engine is fed as soon as FIP_HASH_CHUNK bytes are
+ * available. The trailing IMAGE_INFO_T is not part of the hash and the
+ * final image size is only known once loading is done, so that many
+ * bytes are held back until ma35d1_fip_hash_finish(). Any out of order
+ * chunk drops the stream and the verify falls back to a full pass.
+ */
+#define FIP_HASH_CHUNK		0x10000U
+#define FIP_HASH_HOLDBACK	sizeof(IMAGE_INFO_T)
+
+static struct {
+	int active;
+	int tsi;
+	int sid;
+	int started;
+	uintptr_t base;
+	uintptr_t next;		/* first byte not yet hashed */
+	uintptr_t loaded;	/* end of contiguous data from base */
+	uintptr_t limit;
+} fip_hash;
+
+static void ma35d1_fip_hash_abort(void)
+{
+	ma35d1_fip_aes_abort();
+	if (fip_hash.active && fip_hash.tsi)
+		TSI_Close_Session(C_CODE_SHA, fip_hash.sid);
+	fip_hash.active = 0;
+}
+
+static void ma35d1_fip_hash_start(uintptr_t base, size_t max_size)
+{
+	ma35d1_fip_hash_abort();
+	ma35d1_crypto_engine_init();
+
+	fip_aes.broken = 0;
+	fip_hash.tsi = ma35d1_use_tsi();
+	fip_hash.started = 0;
+	fip_hash.base = base;
+	fip_hash.next = base;
+	fip_hash.loaded = base;
+	fip_hash.limit = base + max_size;
+
+	if (fip_hash.tsi) {
+		if (TSI_Open_Session(C_CODE_SHA, &fip_hash.sid) != 0)
+			return;
+		if (TSI_SHA_Start(fip_hash.sid, 1, 1, 0, 0, SHA_MODE_SHA256,
+				  0, 0, 0) != 0) {
+			TSI_Close_Session(C_CODE_SHA, fip_hash.sid);
+			return;
+		}
+	} else {
+		/* SHA mode 256, in/out swap, key len 0 */
+		SHA_Open(SHA_MODE_SHA256, SHA_IN_OUT_SWAP, 0);
+	}
+	fip_hash.active = 1;
+
+#if !TRUSTED_BOARD_BOOT
+	/* without a decrypt stream the whole image is decrypted after verify */
+	if (ma35d1_fip_aes_open(base) != 0)
+		fip_aes.active = 0;
+#endif
+}
+
+/* Hash [next, next + len) of data already in DRAM */
+static int ma35d1_fip_hash_feed(size_t len, int last, unsigned int *digest)
+{
+	int ret;
+
+	flush_dcache_range(fip_hash.next, len);
+
+	if (fip_hash.tsi) {
+		if (last) {
+			inv_dcache_range((uintptr_t)digest, 32);
+			ret = TSI_SHA_Finish(fip_hash.sid, 8, len, fip_hash.next,
+					     (uintptr_t)digest);
+			inv_dcache_range((uintptr_t)digest, 32);
+		} else {
+			ret = TSI_SHA_Update(fip_hash.sid, len, fip_hash.next);
+		}
+	} else {
+		SHA_SetDMATransfer(fip_hash.next, len);
+		if (last)
+			SHA_Start(fip_hash.started ? CRYPTO_DMA_LAST :
+				  CRYPTO_DMA_ONE_SHOT);
+		else
+			SHA_Start(fip_hash.started ? CRYPTO_DMA_CONTINUE :
+				  CRYPTO_DMA_FIRST);
+		ret = SHA_Wait();
+		if ((ret == 0) && last)
+			SHA_Read(digest);
+	}
+
+	fip_hash.started = 1;
+	fip_hash.next += len;
+	return ret;
+}
+
+void ma35d1_fip_hash_update(uintptr_t buf, size_t size)
+{
+	size_t len;
+
+	if (!fip_hash.active || (buf >= fip_hash.limit) ||
+	    ((buf + size) <= fip_hash.base))
+		return;
+
+	if ((buf > fip_hash.loaded) || (buf < fip_hash.base)) {
+		/* not contiguous, leave it to the full pass */
+		ma35d1_fip_hash_abort();
+		return;
+	}
+	fip_hash.loaded = MAX(fip_hash.loaded, buf + size);
+
+	if ((fip_hash.loaded - fip_hash.next) <= (FIP_HASH_CHUNK + FIP_HASH_HOLDBACK))
+		return;
+
+	/* always leave at least one byte for the final block */
+	len = (fip_hash.loaded - fip_hash.next - FIP_HASH_HOLDBACK - 1U) &
+	      ~(FIP_HASH_CHUNK - 1U);
+	if (ma35d1_fip_hash_feed(len, 0, NULL) != 0) {
+		ma35d1_fip_hash_abort();
+		return;
+	}
+
+	if (fip_aes.active && (ma35d1_fip_aes_feed(len, 0) != 0))
+		ma35d1_fip_aes_abort();
+}
+
+/* Complete the streamed hash of an image of <size> bytes at base */
+static int ma35d1_fip_hash_finish(uintptr_t base, size_t size,
+				  unsigned int *digest)
+{
+	int ret;
+
+	if (!fip_hash.active || (fip_hash.base != base) ||
+	    (fip_hash.loaded != (base + size)) ||
+	    (fip_hash.next > (base + size - sizeof(IMAGE_INFO_T)))) {
+		ma35d1_fip_hash_abort();
+		return -1;
+	}
+
+	ret = ma35d1_fip_hash_feed(base + size - sizeof(IMAGE_INFO_T) -
+				   fip_hash.next, 1, digest);
+	if (fip_hash.tsi)
+		TSI_Close_Session(C_CODE_SHA, fip_hash.sid);
+	fip_hash.active = 0;
+	return ret;
+}
+
+int ma35d1_fip_verify(uintptr_t base, size_t size) {
+	IMAGE_INFO_T *image_info;
+	unsigned int shaDigest[8];
+	unsigned char image[256];
+	char *param = (char *)(TSI_PARAM_BASE);
+	int streamed;
+
+	/* nothing loaded, nothing to check; too short to carry a signature */
+	if (size <= sizeof(IMAGE_INFO_T)) {
+		ma35d1_fip_hash_abort();
+		return (size == 0U) ? 0 : 1;
+	}
+
+	image_info = (IMAGE_INFO_T *)image;
+	memcpy(image,(unsigned char *)base+size-sizeof(IMAGE_INFO_T),sizeof(IMAGE_INFO_T));
+
+	/* digest computed while the image was loading, if possible */
+	streamed = (ma35d1_fip_hash_finish(base, size, shaDigest) == 0);
+	if (!streamed && fip_aes.broken) {
+		/* the ciphertext is partly gone, the caller must read it again */
+		return -EAGAIN;
+	}
+	ma35d1_crypto_engine_init();
+
+	if (ma35d1_use_tsi())
+	{
+		if (!streamed &&
+		    TSI_run_sha(	1,                          /* inswap        */
 					1,                          /* outswap       */
 					0,                          /* mode_sel      */
 					0,                          /* hmac          */
@@ -76,21 +390,10 @@ int ma35d1_fip_verify(uintptr_t base, size_t size) {
 		}
 
 		/* ECC authenticate */
-		/* parameters */
-		ptr = (unsigned int *)shaDigest;
-		for (j=7, k=0; j>=0; j--, k++)
-			tmpbuf[j] = Swap32(*(ptr+k));
-		Reg2Hex(64, tmpbuf, param);
-
-		ptr = (unsigned int *)image_info->signatureR;
-		for (j=7, k=0; j>=0; j--, k++)
-			tmpbuf[j] = Swap32(*(ptr+k));
-		Reg2Hex(64, tmpbuf, (param+1728));
-
-		ptr = (unsigned int *)image_info->signatureS;
-		for (j=7, k=0; j>=0; j--, k++)
-			tmpbuf[j] = Swap32(*(ptr+k));
-		Reg2Hex(64, tmpbuf, (param+2304));
+		/* parameters, the TSI command takes hex strings */
+		hex_to_string((unsigned char *)shaDigest, 32, param);
+		hex_to_string((unsigned char *)image_info->signatureR, 32, (param+1728));
+		hex_to_string((unsigned char *)image_info->signatureS, 32, (param+2304));
 
 		inv_dcache_range((uintptr_t)param, 4096);
 
@@ -98,43 +401,26 @@ int ma35d1_fip_verify(uintptr_t base, size_t size) {
 			return 1;
 	} else { /* crypto */
 
-		/* initial crypto engine and ks clock */
-                mmio_write_32((TSI_CLK_BASE+0x04),
-                            (mmio_read_32(TSI_CLK_BASE+0x04) | 0x5000));
-
-                /* Init KeyStore */
-                /* KS INIT(KS_CTL[8]) + START(KS_CTL[0]) */
-                mmio_write_32(KS_BASE+0x00, 0x101);
-                while ((mmio_read_32(KS_BASE+0x08) & 0x80) == 0)
-                        ;   /* wait for INITDONE(KS_STS[7]) set */
-                while (mmio_read_32(KS_BASE+0x08) & 0x4)
-                        ;      /* wait for BUSY(KS_STS[2]) cleared */
-
-		/* enable SHA, AES, and ECC */
-		/* SHA mode 256, in/out swap, key len 0 */
-		SHA_Open(SHA_MODE_SHA256, SHA_IN_OUT_SWAP, 0);
-
-		/* calculate SHA-256 HASH */
-		SHA_SetDMATransfer(base, size-sizeof(IMAGE_INFO_T));
-		SHA_Start(CRYPTO_DMA_ONE_SHOT);
-
-		SHA_Read(shaDigest);
-		for (j=7, k=0; j>=0; j--, k++)
-			tmpbuf[j] = Swap32(shaDigest[k]);
-		Reg2Hex(64, tmpbuf, param);
+		if (!streamed) {
+			/* enable SHA, AES, and ECC */
+			/* SHA mode 256, in/out swap, key len 0 */
+			SHA_Open(SHA_MODE_SHA256, SHA_IN_OUT_SWAP, 0);
 
-		ptr = (unsigned int *)image_info->signatureR;
-		for (j=7, k=0; j>=0; j--, k++)
-			tmpbuf[j] = Swap32(*(ptr+k));
-		Reg2Hex(64, tmpbuf, (param+128));
+			/* calculate SHA-256 HASH */
+			flush_dcache_range(base, size);
+			SHA_SetDMATransfer(base, size-sizeof(IMAGE_INFO_T));
+			SHA_Start(CRYPTO_DMA_ONE_SHOT);
+			if (SHA_Wait() != 0)
+				return 1;
 
-		ptr = (unsigned int *)image_info->signatureS;
-		for (j=7, k=0; j>=0; j--, k++)
-			tmpbuf[j] = Swap32(*(ptr+k));
-		Reg2Hex(64, tmpbuf, (param+256));
+			SHA_Read(shaDigest);
+		}
 
+		/* digest and (R,S) are big-endian byte strings */
 		inv_dcache_range(base, size);
-		if (ECC_VerifySignature_KS(param, 0x86, 0x87, (param+128), (param+256)) < 0)
+		if (ECC_VerifySignature_KS((unsigned char *)shaDigest, 0x86, 0x87,
+					   (unsigned char *)image_info->signatureR,
+					   (unsigned char *)image_info->signatureS) < 0)
 			return 1;
 	}
 
@@ -142,65 +428,34 @@ int ma35d1_fip_verify(uintptr_t base, size_t size) {
 }
 
 int ma35d1_fip_deaes(uintptr_t base, size_t size) {
-	int sid, j;
-	volatile unsigned char *param = (volatile unsigned char *)TSI_PARAM_BASE;
-	unsigned int volatile u32SysCfg;
-
-	if (size <= 0)
-		return 0;
-	u32SysCfg = mmio_read_32(SYS_CHIPCFG);
-	if ((u32SysCfg & 0x100) == 0x000)       /* 0: TSI; 1: crypto */
-	{
+	uintptr_t end = base + size - sizeof(IMAGE_INFO_T);
+	int ret;
 
-		/* AES decrypt */
-		if (TSI_Open_Session(C_CODE_AES, &sid) != 0)
-			return 1;
-		inv_dcache_range(TSI_PARAM_BASE, 32);
-		for (j=0; j<32; j++)
-			*(param+j) = 0;
-		inv_dcache_range(TSI_PARAM_BASE, 32);
-		if (TSI_AES_Set_IV(sid, (unsigned int)TSI_PARAM_BASE) != 0)
-			return 1;
-		if (TSI_AES_Set_Mode(sid, 0, 0, 1, 1, 0, 0, 2, AES_KEY_SIZE_256, 5, 8) != 0)
-			return 1;
-		if (TSI_AES_Run(sid, 1, size-sizeof(IMAGE_INFO_T), base, base) != 0)
-			return 1;
-		TSI_Close_Session(C_CODE_AES, sid);
-		inv_dcache_range(base, size);
-	} else { /* crypto */
-
-		/* AES, channel 0, AES decode, CFB mode, key 256, in/out swap */
-		mmio_write_32(AES_IV(0), 0);
-		mmio_write_32(AES_IV(1), 0);
-		mmio_write_32(AES_IV(2), 0);
-		mmio_write_32(AES_IV(3), 0);
-
-		/* AES decrypt */
-		mmio_write_32(AES_SADDR, base);
-		mmio_write_32(AES_DADDR, base);
-		mmio_write_32(AES_CNT, base);
+	if (size <= sizeof(IMAGE_INFO_T)) {
+		ma35d1_fip_aes_abort();
+		return (size == 0U) ? 0 : 1;
+	}
 
-		/* 0x2<<KSCTL_RSSRC_Pos | KSCTL_RSRC_Msk | 8 */
-		mmio_write_32(AES_KSCTL,  (0x2<<6) | (0x1<<5) | 8); /* from KS_OTP */
+	if (fip_aes.broken)
+		return 1;
 
-		/* ((AES_MODE_CFB << CRPT_AES_CTL_OPMODE_Pos) |
-		   (AES_KEY_SIZE_256 << CRPT_AES_CTL_KEYSZ_Pos)) |
-		   CRPT_AES_CTL_INSWAP_Msk | CRPT_AES_CTL_OUTSWAP_Msk |
-		   CRPT_AES_CTL_DMAEN_Msk | CRPT_AES_CTL_DMALAST_Msk | CRPT_AES_CTL_START_Msk  */
-		mmio_write_32(AES_CTL, ((2<<8) | (2<<2)) | (1<<23) | (1<<22) |
-				(1<<7) | (1<<5) | (1<<0));
-		while (1)
-		{
-			/* CRPT_INTSTS_AESIF_Msk|CRPT_INTSTS_AESEIF_Msk */
-			if(mmio_read_32(INTSTS) & ((1<<0)|(1<<1)) )
-			{
-				mmio_write_32(INTSTS,((1<<0)|(1<<1)));
-			}
-		}
-		inv_dcache_range(base, size);
+	/* decrypt what the stream has not covered, or all of it */
+	if (fip_aes.active && ((fip_aes.next < base) || (fip_aes.next >= end))) {
+		ma35d1_fip_aes_abort();
+		return 1;
+	}
+	if (!fip_aes.active) {
+		ma35d1_crypto_engine_init();
+		if (ma35d1_fip_aes_open(base) != 0)
+			return 1;
 	}
 
-	return 0;
+	ret = ma35d1_fip_aes_feed(end - fip_aes.next, 1);
+	if (fip_aes.tsi)
+		TSI_Close_Session(C_CODE_AES, fip_aes.sid);
+	fip_aes.active = 0;
+
+	return ret;
 }
 #endif
 
@@ -320,6 +575,22 @@ static uint32_t ma35d1_get_spsr_for_bl33_entry(void)
 	return spsr;
 }
 
+/*******************************************************************************
+ * Start hashing the image as it is read, the digest is checked once the
+ * image is loaded.
+ ******************************************************************************/
+int bl2_plat_handle_pre_image_load(unsigned int image_id)
+{
+#if FIP_DE_AES
+	bl_mem_params_node_t *bl_mem_params = get_bl_mem_params_node(image_id);
+
+	if (bl_mem_params != NULL)
+		ma35d1_fip_hash_start(bl_mem_params->image_info.image_base,
+				      bl_mem_params->image_info.image_max_size);
+#endif
+	return 0;
+}
+
 /*******************************************************************************
  * This function can be used by the platforms to update/use image
  * information for given `image_id`.
@@ -335,11 +606,29 @@ int bl2_plat_handle_post_image_load(unsigned int image_id)
 	assert(bl_mem_params != NULL);
 
 #if FIP_DE_AES
-	if(ma35d1_fip_verify(bl_mem_params->image_info.image_base,bl_mem_params->image_info.image_size)!=0) {
+	err = ma35d1_fip_verify(bl_mem_params->image_info.image_base,
+				bl_mem_params->image_info.image_size);
+	if (err == -EAGAIN) {
+		/*
+		 * The hash stream dropped after part of the image had been
+		 * decrypted in place. Load it again, the stream is inactive
+		 * now, and check it with a full pass.
+		 */
+		WARN("BL2: reloading image %u for a full verify\n", image_id);
+		fip_aes.broken = 0;
+		err = load_auth_image(image_id, &bl_mem_params->image_info);
+		if (err == 0)
+			err = ma35d1_fip_verify(bl_mem_params->image_info.image_base,
+						bl_mem_params->image_info.image_size);
+	}
+	if (err != 0) {
 		ERROR("ECC authenticate fail.\n");
 		while(1);
 	}
-	ma35d1_fip_deaes(bl_mem_params->image_info.image_base,bl_mem_params->image_info.image_size);
+	if(ma35d1_fip_deaes(bl_mem_params->image_info.image_base,bl_mem_params->image_info.image_size)!=0) {
+		ERROR("AES decrypt fail.\n");
+		while(1);
+	}
 #endif
 	switch (image_id) {
 	case BL32_IMAGE_ID:
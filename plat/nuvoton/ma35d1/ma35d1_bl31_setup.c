@@ -158,6 +158,10 @@ void bl31_platform_setup(void)
 	gicv2_cpuif_enable();
 
 	plat_ma35d1_init();
+	ma35d1_dvfs_init((void *)MA35D1_DTB_BASE);
+
+	/* Seed the SiP RNG while BL31 still owns the TSI and CRYPTO block */
+	ma35d1_rng_init();
 }
 
 void bl31_plat_runtime_setup(void)
@@ -322,6 +322,12 @@ void ma35d1_timer_init(void)
 	generic_delay_timer_init();
 }
 
+/* Crypto requests go to the TSI or to the CRYPTO block, per SYS_CHIPCFG */
+int ma35d1_use_tsi(void)
+{
+	return (mmio_read_32(SYS_CHIPCFG) & 0x100) == 0x000; /* 0: TSI; 1: crypto */
+}
+
 void plat_ma35d1_init(void)
 {
 	int value_len = 0, i, count = 0;
@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2020 Nuvoton Technology Corp. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+/* mbed TLS headers, for the ASN.1 parsing only */
+#include <mbedtls/asn1.h>
+#include <mbedtls/md.h>
+#include <mbedtls/oid.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <drivers/auth/crypto_mod.h>
+#include <drivers/auth/mbedtls/mbedtls_common.h>
+#include <lib/mmio.h>
+#include <lib/utils_def.h>
+#include <plat/common/platform.h>
+#include <platform_def.h>
+
+#include "ma35d1_private.h"
+#include <ma35d1_crypto.h>
+#include <tsi_cmd.h>
+
+#define LIB_NAME		"MA35D1 CRYPTO/TSI"
+
+/* Largest digest computed here, SHA-512 */
+#define MA35D1_MAX_DIGEST	64
+
+/* TSI_ECC_VerifySignature() parameter block, hex strings */
+#define TSI_ECC_PARAM_E		0
+#define TSI_ECC_PARAM_QX	576
+#define TSI_ECC_PARAM_QY	1152
+#define TSI_ECC_PARAM_R		1728
+#define TSI_ECC_PARAM_S		2304
+
+/*
+ * SHA-256/384/512 and ECDSA P-256/P-384 run on the TSI or on the CRYPTO
+ * block, whichever SYS_CHIPCFG selects. The DER structures are the ones
+ * described in mbedtls_crypto.c and are parsed with the mbed TLS ASN.1
+ * helpers; mbed TLS does no arithmetic here.
+ */
+
+static unsigned int digest_buf[MA35D1_MAX_DIGEST / 4]
+	__aligned(CACHE_WRITEBACK_GRANULE);
+
+/* Digest length in bytes and the engine SHA mode, from an md OID */
+static int ma35d1_md_from_oid(const mbedtls_asn1_buf *oid, int *mode)
+{
+	if (MBEDTLS_OID_CMP(MBEDTLS_OID_DIGEST_ALG_SHA256, oid) == 0) {
+		*mode = SHA_MODE_SHA256;
+		return 32;
+	}
+	if (MBEDTLS_OID_CMP(MBEDTLS_OID_DIGEST_ALG_SHA384, oid) == 0) {
+		*mode = SHA_MODE_SHA384;
+		return 48;
+	}
+	if (MBEDTLS_OID_CMP(MBEDTLS_OID_DIGEST_ALG_SHA512, oid) == 0) {
+		*mode = SHA_MODE_SHA512;
+		return 64;
+	}
+	return -1;
+}
+
+/* Hash data_len bytes at data_ptr into digest_buf */
+static int ma35d1_sha(int mode, int len, void *data_ptr, unsigned int data_len)
+{
+	uintptr_t data = (uintptr_t)data_ptr;
+
+	/* both engines take 32-bit DMA addresses */
+	if (((data + data_len) >> 32) != 0U)
+		return -1;
+
+	flush_dcache_range(data, data_len);
+
+	if (ma35d1_use_tsi()) {
+		return TSI_run_sha(1, 1, 0, 0, mode, 0, 0, 0, len / 4,
+				   data_len, (unsigned int)data,
+				   (unsigned int)(uintptr_t)digest_buf);
+	}
+
+	SHA_Open(mode, SHA_IN_OUT_SWAP, 0);
+	SHA_SetDMATransfer((unsigned int)data, data_len);
+	SHA_Start(CRYPTO_DMA_ONE_SHOT);
+	if (SHA_Wait() != 0)
+		return -1;
+	SHA_Read(digest_buf);
+	return 0;
+}
+
+/* Copy an ASN.1 INTEGER into a big-endian buffer of exactly len bytes */
+static int ma35d1_get_int(unsigned char **p, const unsigned char *end,
+			  unsigned char *out, size_t len)
+{
+	size_t n;
+
+	if (mbedtls_asn1_get_tag(p, end, &n, MBEDTLS_ASN1_INTEGER) != 0)
+		return -1;
+
+	/* drop the sign padding */
+	while ((n > 0U) && (**p == 0U)) {
+		(*p)++;
+		n--;
+	}
+	if (n > len)
+		return -1;
+
+	memset(out, 0, len - n);
+	memcpy(out + len - n, *p, n);
+	*p += n;
+	return 0;
+}
+
+static int ma35d1_ecdsa_verify(int key_len, const unsigned char *hash,
+			       int hash_len, const unsigned char *qx,
+			       const unsigned char *qy, const unsigned char *r,
+			       const unsigned char *s)
+{
+	char *param = (char *)TSI_PARAM_BASE;
+	int bytes = key_len / 8;
+
+	if (!ma35d1_use_tsi())
+		return ECC_VerifySignature(key_len, hash, hash_len, qx, qy, r, s);
+
+	/* the TSI command takes hex strings */
+	hex_to_string((unsigned char *)hash, MIN(hash_len, bytes),
+		      param + TSI_ECC_PARAM_E);
+	hex_to_string((unsigned char *)qx, bytes, param + TSI_ECC_PARAM_QX);
+	hex_to_string((unsigned char *)qy, bytes, param + TSI_ECC_PARAM_QY);
+	hex_to_string((unsigned char *)r, bytes, param + TSI_ECC_PARAM_R);
+	hex_to_string((unsigned char *)s, bytes, param + TSI_ECC_PARAM_S);
+	flush_dcache_range(TSI_PARAM_BASE, 4096);
+
+	return TSI_ECC_VerifySignature((key_len == 256) ? CURVE_P_256 : CURVE_P_384,
+				       ECC_KEY_SEL_USER, 0, 0, TSI_PARAM_BASE);
+}
+
+static void init(void)
+{
+	/* The X.509 parser still allocates from the mbed TLS heap */
+	mbedtls_init();
+	ma35d1_crypto_engine_init();
+}
+
+/*
+ * Verify an ECDSA signature. Only ECDSA with SHA-256/384/512 over P-256
+ * or P-384 keys is supported.
+ */
+static int ma35d1_verify_signature(void *data_ptr, unsigned int data_len,
+				   void *sig_ptr, unsigned int sig_len,
+				   void *sig_alg, unsigned int sig_alg_len,
+				   void *pk_ptr, unsigned int pk_len)
+{
+	mbedtls_asn1_buf sig_oid, sig_params, pk_oid, pk_params;
+	unsigned char r[ECC_P384_BYTES], s[ECC_P384_BYTES];
+	unsigned char *p, *end, *q;
+	size_t len;
+	int mode, md_len, key_len, bytes;
+
+	/* Signature algorithm: ecdsa-with-SHAxxx, no parameters */
+	p = (unsigned char *)sig_alg;
+	end = p + sig_alg_len;
+	if (mbedtls_asn1_get_alg(&p, end, &sig_oid, &sig_params) != 0)
+		return CRYPTO_ERR_SIGNATURE;
+
+	if (MBEDTLS_OID_CMP(MBEDTLS_OID_ECDSA_SHA256, &sig_oid) == 0) {
+		mode = SHA_MODE_SHA256;
+		md_len = 32;
+	} else if (MBEDTLS_OID_CMP(MBEDTLS_OID_ECDSA_SHA384, &sig_oid) == 0) {
+		mode = SHA_MODE_SHA384;
+		md_len = 48;
+	} else if (MBEDTLS_OID_CMP(MBEDTLS_OID_ECDSA_SHA512, &sig_oid) == 0) {
+		mode = SHA_MODE_SHA512;
+		md_len = 64;
+	} else {
+		return CRYPTO_ERR_SIGNATURE;
+	}
+
+	/* SubjectPublicKeyInfo: id-ecPublicKey, named curve, 04 || X || Y */
+	p = (unsigned char *)pk_ptr;
+	end = p + pk_len;
+	if ((mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED |
+				  MBEDTLS_ASN1_SEQUENCE) != 0) ||
+	    (mbedtls_asn1_get_alg(&p, end, &pk_oid, &pk_params) != 0) ||
+	    (MBEDTLS_OID_CMP(MBEDTLS_OID_EC_ALG_UNRESTRICTED, &pk_oid) != 0) ||
+	    (pk_params.tag != MBEDTLS_ASN1_OID))
+		return CRYPTO_ERR_SIGNATURE;
+
+	if (MBEDTLS_OID_CMP(MBEDTLS_OID_EC_GRP_SECP256R1, &pk_params) == 0)
+		key_len = 256;
+	else if (MBEDTLS_OID_CMP(MBEDTLS_OID_EC_GRP_SECP384R1, &pk_params) == 0)
+		key_len = 384;
+	else
+		return CRYPTO_ERR_SIGNATURE;
+	bytes = key_len / 8;
+
+	if ((mbedtls_asn1_get_bitstring_null(&p, end, &len) != 0) ||
+	    (len != (size_t)(1 + (2 * bytes))) || (*p != 0x04))
+		return CRYPTO_ERR_SIGNATURE;
+	q = p + 1;
+
+	/* Signature: BIT STRING holding SEQUENCE { r INTEGER, s INTEGER } */
+	p = (unsigned char *)sig_ptr;
+	end = p + sig_len;
+	if ((mbedtls_asn1_get_bitstring_null(&p, end, &len) != 0) ||
+	    (mbedtls_asn1_get_tag(&p, p + len, &len, MBEDTLS_ASN1_CONSTRUCTED |
+				  MBEDTLS_ASN1_SEQUENCE) != 0))
+		return CRYPTO_ERR_SIGNATURE;
+	end = p + len;
+	if ((ma35d1_get_int(&p, end, r, bytes) != 0) ||
+	    (ma35d1_get_int(&p, end, s, bytes) != 0) || (p != end))
+		return CRYPTO_ERR_SIGNATURE;
+
+	if (ma35d1_sha(mode, md_len, data_ptr, data_len) != 0)
+		return CRYPTO_ERR_SIGNATURE;
+
+	if (ma35d1_ecdsa_verify(key_len, (unsigned char *)digest_buf, md_len,
+				q, q + bytes, r, s) != 0)
+		return CRYPTO_ERR_SIGNATURE;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Match a hash, digest info is a DER encoded DigestInfo.
+ */
+static int ma35d1_verify_hash(void *data_ptr, unsigned int data_len,
+			      void *digest_info_ptr, unsigned int digest_info_len)
+{
+	mbedtls_asn1_buf hash_oid, params;
+	unsigned char *p, *end;
+	size_t len;
+	int mode, md_len;
+
+	p = (unsigned char *)digest_info_ptr;
+	end = p + digest_info_len;
+	if ((mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_CONSTRUCTED |
+				  MBEDTLS_ASN1_SEQUENCE) != 0) ||
+	    (mbedtls_asn1_get_alg(&p, end, &hash_oid, &params) != 0))
+		return CRYPTO_ERR_HASH;
+
+	md_len = ma35d1_md_from_oid(&hash_oid, &mode);
+	if (md_len < 0)
+		return CRYPTO_ERR_HASH;
+
+	if ((mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_OCTET_STRING) != 0) ||
+	    (len != (size_t)md_len))
+		return CRYPTO_ERR_HASH;
+
+	if (ma35d1_sha(mode, md_len, data_ptr, data_len) != 0)
+		return CRYPTO_ERR_HASH;
+
+	if (memcmp(digest_buf, p, md_len) != 0)
+		return CRYPTO_ERR_HASH;
+
+	return CRYPTO_SUCCESS;
+}
+
+/*
+ * Only the ASN.1 parsing goes through mbed TLS, the heap steps report
+ * whether it ever allocates.
+ */
+static int verify_signature(void *data_ptr, unsigned int data_len,
+			    void *sig_ptr, unsigned int sig_len,
+			    void *sig_alg, unsigned int sig_alg_len,
+			    void *pk_ptr, unsigned int pk_len)
+{
+	int rc;
+
+	mbedtls_heap_step_begin();
+	rc = ma35d1_verify_signature(data_ptr, data_len, sig_ptr, sig_len,
+				     sig_alg, sig_alg_len, pk_ptr, pk_len);
+	mbedtls_heap_step_end("signature");
+	return rc;
+}
+
+static int verify_hash(void *data_ptr, unsigned int data_len,
+		       void *digest_info_ptr, unsigned int digest_info_len)
+{
+	int rc;
+
+	mbedtls_heap_step_begin();
+	rc = ma35d1_verify_hash(data_ptr, data_len, digest_info_ptr,
+				digest_info_len);
+	mbedtls_heap_step_end("hash");
+	return rc;
+}
+
+#if MEASURED_BOOT
+/*
+ * Calculate a hash, alg is an mbedtls_md_type_t
+ */
+static int calc_hash(unsigned int alg, void *data_ptr,
+		     unsigned int data_len, unsigned char *output)
+{
+	int mode, md_len;
+
+	switch (alg) {
+	case MBEDTLS_MD_SHA256:
+		mode = SHA_MODE_SHA256;
+		md_len = 32;
+		break;
+	case MBEDTLS_MD_SHA384:
+		mode = SHA_MODE_SHA384;
+		md_len = 48;
+		break;
+	case MBEDTLS_MD_SHA512:
+		mode = SHA_MODE_SHA512;
+		md_len = 64;
+		break;
+	default:
+		return CRYPTO_ERR_HASH;
+	}
+
+	if (ma35d1_sha(mode, md_len, data_ptr, data_len) != 0)
+		return CRYPTO_ERR_HASH;
+
+	memcpy(output, digest_buf, md_len);
+	return CRYPTO_SUCCESS;
+}
+
+REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash,
+		    calc_hash, NULL);
+#else
+REGISTER_CRYPTO_LIB(LIB_NAME, init, verify_signature, verify_hash, NULL);
+#endif /* MEASURED_BOOT */
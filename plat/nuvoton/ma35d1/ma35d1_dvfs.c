@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 Nuvoton Technology Corp.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+
+#include <libfdt.h>
+
+#include <common/debug.h>
+#include <common/fdt_wrappers.h>
+#include <drivers/delay_timer.h>
+#include <lib/utils_def.h>
+
+#include <drivers/nuvoton/ma35d1_pmic.h>
+#include "ma35d1_private.h"
+
+/*
+ * CA35 operating points. The table comes from the "nuvoton,ma35d1-cpu-opp"
+ * node: operating-points = <kHz uV>, one pair per OPP. A transition raises
+ * VDD_CPU and waits for it to settle before the clock goes up, and lowers it
+ * only after the clock has come down, so the core never runs faster than its
+ * supply allows. Callers serialise transitions and unlock the clock
+ * registers (see the SiP dispatcher).
+ */
+#define DVFS_MAX_OPPS		8
+#define DVFS_SETTLE_US		100
+
+typedef struct {
+	unsigned int mhz;
+	int pll;		/* CPU_PLL_xxx */
+	int vol;		/* PMIC units of 10 mV */
+} ma35d1_opp_t;
+
+/* CA-PLL settings that ma35d1_set_cpu_clock() knows about */
+static const struct {
+	unsigned int mhz;
+	int pll;
+} capll_opps[] = {
+	{ 1000, CPU_PLL_1G },
+	{ 800, CPU_PLL_800 },
+	{ 700, CPU_PLL_700 },
+	{ 600, CPU_PLL_600 },
+	{ 500, CPU_PLL_500 },
+	{ 250, CPU_PLL_250 },
+	{ 125, CPU_PLL_125 },
+};
+
+static ma35d1_opp_t opps[DVFS_MAX_OPPS];
+static unsigned int opp_num;
+static unsigned int opp_settle_us = DVFS_SETTLE_US;
+
+static int dvfs_pll_code(unsigned int mhz)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(capll_opps); i++) {
+		if (capll_opps[i].mhz == mhz)
+			return capll_opps[i].pll;
+	}
+	return -1;
+}
+
+void ma35d1_dvfs_init(void *fdt)
+{
+	const fdt32_t *prop;
+	unsigned int mhz, i;
+	int node, len, pll;
+	uint32_t uv;
+
+	opp_num = 0;
+
+	if (fdt_check_header(fdt) < 0)
+		return;
+
+	node = fdt_node_offset_by_compatible(fdt, -1, "nuvoton,ma35d1-cpu-opp");
+	if (node < 0)
+		return;
+
+	prop = fdt_getprop(fdt, node, "operating-points", &len);
+	if ((prop == NULL) || ((len % (2 * sizeof(uint32_t))) != 0)) {
+		WARN("DVFS: bad operating-points\n");
+		return;
+	}
+
+	for (i = 0; i < (len / (2 * sizeof(uint32_t))); i++) {
+		mhz = fdt32_to_cpu(prop[2 * i]) / 1000U;
+		uv = fdt32_to_cpu(prop[2 * i + 1]);
+
+		pll = dvfs_pll_code(mhz);
+		if (pll < 0) {
+			WARN("DVFS: no CA-PLL setting for %u MHz\n", mhz);
+			continue;
+		}
+		if (opp_num == DVFS_MAX_OPPS) {
+			WARN("DVFS: too many operating points\n");
+			break;
+		}
+		opps[opp_num].mhz = mhz;
+		opps[opp_num].pll = pll;
+		opps[opp_num].vol = (int)(uv / 10000U);
+		opp_num++;
+	}
+
+	opp_settle_us = fdt_read_uint32_default(fdt, node, "voltage-settle-us",
+						DVFS_SETTLE_US);
+
+	INFO("DVFS: %u operating points, CPU at %u MHz\n", opp_num,
+	     ma35d1_get_cpu_clock());
+}
+
+/*
+ * Move the CA35 to the operating point running at 'mhz'. Returns 0,
+ * -EINVAL if there is no such OPP, -ENODEV if no table was found, or -EIO
+ * if the PMIC or the PLL did not respond. If the PMIC fails the core is
+ * left at its old clock and voltage. If the CA-PLL does not lock, the
+ * core is left running from DDR-PLL with PLL0CTL0 already set for the
+ * new rate, at a voltage no lower than either OPP needs.
+ */
+int ma35d1_dvfs_set(unsigned int mhz)
+{
+	const ma35d1_opp_t *opp = NULL;
+	unsigned int i;
+	int vol;
+
+	if (opp_num == 0)
+		return -ENODEV;
+
+	for (i = 0; i < opp_num; i++) {
+		if (opps[i].mhz == mhz) {
+			opp = &opps[i];
+			break;
+		}
+	}
+	if (opp == NULL)
+		return -EINVAL;
+
+	vol = ma35d1_get_pmic(VOL_CPU);
+
+	if (opp->vol > vol) {
+		if (ma35d1_set_pmic(VOL_CPU, opp->vol) != 1) {
+			ERROR("DVFS: cannot raise VDD_CPU to %d0 mV\n",
+			      opp->vol);
+			return -EIO;
+		}
+		udelay(opp_settle_us);
+	}
+
+	if (ma35d1_get_cpu_clock() != mhz) {
+		if (ma35d1_set_cpu_clock(opp->pll) != 0)
+			return -EIO;
+	}
+
+	/* A supply left high is safe, so only warn if lowering fails */
+	if ((opp->vol < vol) && (ma35d1_set_pmic(VOL_CPU, opp->vol) != 1))
+		WARN("DVFS: cannot lower VDD_CPU to %d0 mV\n", opp->vol);
+
+	return 0;
+}
@@ -216,6 +216,10 @@ static int ma35d1_io_block_setup(struct io_block_dev_spec *block_dev_spec)
 
 	block_dev_spec->buffer.offset = MA35D1_FIP_BASE;
 	block_dev_spec->buffer.length = MA35D1_FIP_SIZE;
+#if FIP_DE_AES
+	/* hash images while they are read, see ma35d1_bl2_setup.c */
+	block_dev_spec->ops.read_done = ma35d1_fip_hash_update;
+#endif
 
 	ret = register_io_dev_block(&backend_dev_con);
 	if (ret)
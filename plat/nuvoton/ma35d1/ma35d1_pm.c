@@ -6,9 +6,13 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <string.h>
+
+#include <libfdt.h>
 
 #include <arch_helpers.h>
 #include <common/debug.h>
+#include <common/fdt_wrappers.h>
 #include <lib/extensions/spe.h>
 #include <lib/mmio.h>
 #include <lib/psci/psci.h>
@@ -35,6 +39,68 @@
 
 static uintptr_t ma35d1_sec_entrypoint;
 
+/*
+ * Composite power-state parameters: the State-ID holds one 4-bit local state
+ * per power level, as in the Arm recommended encoding.
+ */
+#define MA35D1_LOCAL_PSTATE_WIDTH	4
+#define MA35D1_LOCAL_PSTATE_MASK	((1U << MA35D1_LOCAL_PSTATE_WIDTH) - 1U)
+
+#define ma35d1_make_pwrstate(lvl2, lvl1, lvl0, pwr_lvl, type)		\
+	(((((lvl2) << (MA35D1_LOCAL_PSTATE_WIDTH * 2)) |		\
+	   ((lvl1) << MA35D1_LOCAL_PSTATE_WIDTH) | (lvl0))		\
+	  << PSTATE_ID_SHIFT) |						\
+	 ((pwr_lvl) << PSTATE_PWR_LVL_SHIFT) |				\
+	 ((type) << PSTATE_TYPE_SHIFT))
+
+/*
+ * CPU_SUSPEND states. The same parameters are published, with their
+ * latencies, in the /cpus/idle-states node of the device tree, which
+ * selects the ones BL31 accepts. Entries 1 to 3 are the power-down states
+ * of levels 0 to 2, in that order.
+ */
+static const unsigned int ma35d1_idle_states[] = {
+	/* Core retention (WFI), State-ID 0x001 */
+	ma35d1_make_pwrstate(ARM_LOCAL_STATE_RUN, ARM_LOCAL_STATE_RUN,
+			     ARM_LOCAL_STATE_RET, ARM_PWR_LVL0,
+			     PSTATE_TYPE_STANDBY),
+	/*
+	 * Core off, State-ID 0x002. The core has no power switch, so this
+	 * saves nothing over retention; it is not enabled by default and
+	 * only serves legacy level 0 power-down requests.
+	 */
+	ma35d1_make_pwrstate(ARM_LOCAL_STATE_RUN, ARM_LOCAL_STATE_RUN,
+			     ARM_LOCAL_STATE_OFF, ARM_PWR_LVL0,
+			     PSTATE_TYPE_POWERDOWN),
+	/* Core off, cluster clock on HXT, State-ID 0x012 */
+	ma35d1_make_pwrstate(ARM_LOCAL_STATE_RUN, ARM_LOCAL_STATE_RET,
+			     ARM_LOCAL_STATE_OFF, ARM_PWR_LVL1,
+			     PSTATE_TYPE_POWERDOWN),
+	/* System suspend, DDR in self-refresh, State-ID 0x222 */
+	ma35d1_make_pwrstate(ARM_LOCAL_STATE_OFF, ARM_LOCAL_STATE_OFF,
+			     ARM_LOCAL_STATE_OFF, ARM_PWR_LVL2,
+			     PSTATE_TYPE_POWERDOWN),
+};
+
+/* ma35d1_idle_states[] entries accepted by CPU_SUSPEND, one bit each */
+#define MA35D1_IDLE_CORE_OFF		1U
+#define MA35D1_IDLE_SYSTEM		3U
+static unsigned int ma35d1_idle_enabled =
+	(1U << ARRAY_SIZE(ma35d1_idle_states)) - 1U -
+	(1U << MA35D1_IDLE_CORE_OFF) - (1U << MA35D1_IDLE_SYSTEM);
+
+/* CA35 clock source saved by the last core into cluster retention */
+static uint32_t ma35d1_cluster_clksel;
+
+/*
+ * Set by CPU_OFF for ma35d1_pwr_domain_pwr_down_wfi(). The flag is only
+ * accessed with the data cache off, and each core has a cache line of its
+ * own, so no cached copy can ever be written back over it.
+ */
+static struct {
+	uint32_t off;
+} __aligned(CACHE_WRITEBACK_GRANULE) ma35d1_core_state[PLATFORM_CORE_COUNT];
+
 #define SYS_BASE 0x40460000
 #define PMUCR 0x30
 #define DDRCQCSR 0x34
@@ -50,6 +116,12 @@ static uintptr_t ma35d1_sec_entrypoint;
 #define PWRCTL 0x0
 #define STATUS 0x50
 
+/*
+ * Raw SYS_RLKTZS unlock for the system suspend path, which runs with the
+ * MMU off, where the spinlock of ma35d1_reg_unlock() cannot be used, and
+ * with every other core off. Everything else uses the reference counted
+ * ma35d1_reg_unlock()/ma35d1_reg_lock().
+ */
 static __inline void ma35d1_UnlockReg(void)
 {
 	do {
@@ -220,7 +292,7 @@ void ma35d1_ddr_pd(void)
 
 void ma35d1_ddr_wk(void)
 {
-	ma35d1_UnlockReg();
+	ma35d1_reg_unlock();
 
 	//enable DDR AXI port0 clock and DDR AXI port5 clock
 	mmio_write_32(0x40460204, mmio_read_32(0x40460204) | 0x7f000034);
@@ -267,7 +339,7 @@ void ma35d1_ddr_wk(void)
 	//Set ddrc core clock gating circuit enable
 	mmio_write_32((0x40460070), mmio_read_32(0x40460070) & ~(0x00800000));
 
-	ma35d1_LockReg();
+	ma35d1_reg_lock();
 }
 
 void ma35d1_deep_power_down_sw(void)
@@ -301,6 +373,15 @@ void ma35d1_deep_power_down_sw(void)
 }
 #endif
 
+/*
+ * Warm boot entry point register of a core. The core polls it while off,
+ * and the MaskROM reads it when the core comes out of reset.
+ */
+static uintptr_t ma35d1_core_mailbox(unsigned int pos)
+{
+	return SYS_BASE + ((pos == 0U) ? CA35WRBADR1 : CA35WRBADR2);
+}
+
 static void ma35d1_cpu_standby(plat_local_state_t cpu_state)
 {
 
@@ -334,6 +415,7 @@ static int ma35d1_pwr_domain_on(u_register_t mpidr)
 	{
 		mmio_write_32(SYS_BASE + CA35WRBPAR1, 0x7761726D);
 		mmio_write_32(SYS_BASE + CA35WRBADR1, ma35d1_sec_entrypoint);
+		sev();
 	}
 
 	return PSCI_E_SUCCESS;
@@ -341,13 +423,36 @@ static int ma35d1_pwr_domain_on(u_register_t mpidr)
 
 static void ma35d1_pwr_domain_off(const psci_power_state_t *target_state)
 {
+	unsigned int pos = plat_my_core_pos();
 
+	/*
+	 * There is no per-core power switch: the core parks in
+	 * ma35d1_pwr_domain_pwr_down_wfi() until CPU_ON posts its entry point.
+	 */
+	ma35d1_core_state[pos].off = 1U;
+	mmio_write_32(ma35d1_core_mailbox(pos), 0);
+	gicv2_cpuif_disable();
 }
 
 static void ma35d1_pwr_domain_suspend(const psci_power_state_t *target_state)
 {
 	unsigned int reg;
 
+	if (MA35D1_SYSTEM_PWR_STATE(target_state) != PLAT_MAX_OFF_STATE) {
+		/* Last core into cluster retention: run the CA35 from HXT */
+		if (MA35D1_CLUSTER_PWR_STATE(target_state) ==
+		    PLAT_MAX_RET_STATE) {
+			ma35d1_cluster_clksel = mmio_read_32(CLK_CLKSEL0) & 0x3;
+			ma35d1_reg_unlock();
+			mmio_write_32(CLK_CLKSEL0,
+				      mmio_read_32(CLK_CLKSEL0) & ~0x3);
+			ma35d1_reg_lock();
+		}
+		mmio_write_32(ma35d1_core_mailbox(plat_my_core_pos()),
+			      ma35d1_sec_entrypoint);
+		return;
+	}
+
 	disable_mmu_el3();
 
 	if (mmio_read_32(SYS_BASE+DDRCQCSR)&0x0002FF00) {
@@ -384,14 +489,23 @@ int ma35d1_validate_ns_entrypoint(uintptr_t ns_entrypoint)
 static void ma35d1_pwr_domain_suspend_finish(const
 			psci_power_state_t * target_state)
 {
+	if (MA35D1_SYSTEM_PWR_STATE(target_state) == PLAT_MAX_OFF_STATE) {
 #if !MA35D1_DDR_HW_POWER_DOWN
-	ma35d1_ddr_wk();
+		ma35d1_ddr_wk();
 #endif
-	/* Clear poer down flag */
-	mmio_write_32(SYS_BASE + PMUSTS, (1 << 8) | 0x1);
-
-	/* Clear Core 1 Warm-boot */
-	mmio_write_32(SYS_BASE + CA35WRBPAR1, 0);
+		/* Clear poer down flag */
+		mmio_write_32(SYS_BASE + PMUSTS, (1 << 8) | 0x1);
+
+		/* Clear Core 1 Warm-boot */
+		mmio_write_32(SYS_BASE + CA35WRBPAR1, 0);
+	} else if (MA35D1_CLUSTER_PWR_STATE(target_state) ==
+		   PLAT_MAX_RET_STATE) {
+		/* First core out of cluster retention: restore the clock */
+		ma35d1_reg_unlock();
+		mmio_write_32(CLK_CLKSEL0, (mmio_read_32(CLK_CLKSEL0) & ~0x3) |
+			      ma35d1_cluster_clksel);
+		ma35d1_reg_lock();
+	}
 
 	plat_arm_gic_init();
 
@@ -419,7 +533,7 @@ static void __dead2 ma35d1_system_off(void)
 
 static void __dead2 ma35d1_system_reset(void)
 {
-	ma35d1_UnlockReg();
+	ma35d1_reg_unlock();
 	mmio_write_32(SYS_IPRST0, 0x1);
 	mmio_write_32(SYS_IPRST0, 0x0);
 
@@ -431,41 +545,94 @@ static void __dead2 ma35d1_system_reset(void)
 static int ma35d1_validate_power_state(unsigned int power_state,
 					psci_power_state_t * req_state)
 {
-	int pstate = psci_get_pstate_type(power_state);
-	int pwr_lvl = psci_get_pstate_pwrlvl(power_state);
-	int i;
+	unsigned int state_id;
+	unsigned int i;
 
 	assert(req_state);
 
-	if (pwr_lvl > PLAT_MAX_PWR_LVL)
-		return PSCI_E_INVALID_PARAMS;
+	/* Plain standby with a zero State-ID, as before idle states existed */
+	if (power_state == 0U) {
+		req_state->pwr_domain_state[MPIDR_AFFLVL0] = PLAT_MAX_RET_STATE;
+		return PSCI_E_SUCCESS;
+	}
 
-	/* Sanity check the requested state */
-	if (pstate == PSTATE_TYPE_STANDBY) {
+	if ((psci_get_pstate_id(power_state) == 0U) &&
+	    (psci_get_pstate_type(power_state) == PSTATE_TYPE_POWERDOWN)) {
 		/*
-		 * It's probably to enter standby only on power level 0
-		 * ignore any other power level.
+		 * Power-down with a zero State-ID, as before idle states
+		 * existed: the deepest state at that level, entries 1 to 3 of
+		 * ma35d1_idle_states[]. Levels 0 and 1 are accepted whatever
+		 * /cpus/idle-states enables, system suspend only when it is
+		 * enabled there.
 		 */
-		if (pwr_lvl != MPIDR_AFFLVL0)
+		i = psci_get_pstate_pwrlvl(power_state) + 1U;
+		if ((i >= ARRAY_SIZE(ma35d1_idle_states)) ||
+		    ((i == MA35D1_IDLE_SYSTEM) &&
+		     ((ma35d1_idle_enabled & (1U << i)) == 0U)))
 			return PSCI_E_INVALID_PARAMS;
-
-		req_state->pwr_domain_state[MPIDR_AFFLVL0] = PLAT_MAX_RET_STATE;
+		power_state = ma35d1_idle_states[i];
 	} else {
-
-		for (i = MPIDR_AFFLVL0; i <= pwr_lvl; i++)
-			req_state->pwr_domain_state[i] = PLAT_MAX_OFF_STATE;
-
-		for (i = (pwr_lvl); i <= PLAT_MAX_PWR_LVL; i++)
-			req_state->pwr_domain_state[i] = PLAT_MAX_RET_STATE;
+		for (i = 0; i < ARRAY_SIZE(ma35d1_idle_states); i++) {
+			if (power_state == ma35d1_idle_states[i])
+				break;
+		}
+		if ((i == ARRAY_SIZE(ma35d1_idle_states)) ||
+		    ((ma35d1_idle_enabled & (1U << i)) == 0U))
+			return PSCI_E_INVALID_PARAMS;
 	}
 
-	/* We expect the 'state id' to be zero */
-	if (psci_get_pstate_id(power_state))
-		return PSCI_E_INVALID_PARAMS;
+	/* Parse the State-ID into the local state of each level */
+	state_id = psci_get_pstate_id(power_state);
+	for (i = MPIDR_AFFLVL0; i <= PLAT_MAX_PWR_LVL; i++) {
+		req_state->pwr_domain_state[i] =
+			state_id & MA35D1_LOCAL_PSTATE_MASK;
+		state_id >>= MA35D1_LOCAL_PSTATE_WIDTH;
+	}
 
 	return PSCI_E_SUCCESS;
 }
 
+/*
+ * Enable the CPU_SUSPEND states listed in /cpus/idle-states. Without that
+ * node, core and cluster retention are enabled.
+ */
+static void ma35d1_idle_states_init(void *fdt)
+{
+	const char *status;
+	unsigned int enabled = 0, i;
+	uint32_t param;
+	int parent, node;
+
+	if (fdt_check_header(fdt) < 0)
+		return;
+
+	parent = fdt_path_offset(fdt, "/cpus/idle-states");
+	if (parent < 0)
+		return;
+
+	fdt_for_each_subnode(node, fdt, parent) {
+		status = fdt_getprop(fdt, node, "status", NULL);
+		if ((status != NULL) && (strcmp(status, "okay") != 0) &&
+		    (strcmp(status, "ok") != 0))
+			continue;
+		if (fdt_read_uint32(fdt, node, "arm,psci-suspend-param",
+				    &param) != 0)
+			continue;
+
+		for (i = 0; i < ARRAY_SIZE(ma35d1_idle_states); i++) {
+			if (param == ma35d1_idle_states[i])
+				break;
+		}
+		if (i == ARRAY_SIZE(ma35d1_idle_states)) {
+			WARN("PSCI: unsupported idle state 0x%x\n", param);
+			continue;
+		}
+		enabled |= 1U << i;
+	}
+
+	ma35d1_idle_enabled = enabled;
+	INFO("PSCI: idle states 0x%x\n", enabled);
+}
 
 void ma35d1_get_sys_suspend_power_state(psci_power_state_t
         *req_state)
@@ -479,8 +646,36 @@ void ma35d1_get_sys_suspend_power_state(psci_power_state_t
 
 void __dead2 ma35d1_pwr_domain_pwr_down_wfi(const psci_power_state_t * target_state)
 {
+	unsigned int pos = plat_my_core_pos();
+	uintptr_t mbox = ma35d1_core_mailbox(pos);
 	u_register_t scr;
 
+	/*
+	 * CPU_OFF. The mailbox alone can't tell: CPU_ON may already have
+	 * posted the entry point by now.
+	 */
+	if (ma35d1_core_state[pos].off != 0U) {
+		ma35d1_core_state[pos].off = 0U;
+		disable_mmu_el3();
+		while (mmio_read_32(mbox) == 0U)
+			wfe();
+		((void (*)(void))(uintptr_t)mmio_read_32(mbox))();
+		plat_panic_handler();
+	}
+
+	if (MA35D1_SYSTEM_PWR_STATE(target_state) != PLAT_MAX_OFF_STATE) {
+		/*
+		 * Core off: the GIC CPU interface stays enabled, so any
+		 * interrupt ends the WFI. The core keeps power and resumes
+		 * through the warm boot entry point.
+		 */
+		disable_mmu_el3();
+		dsb();
+		wfi();
+		((void (*)(void))(uintptr_t)mmio_read_32(mbox))();
+		plat_panic_handler();
+	}
+
 	scr = read_scr_el3();
 
 	/* Enable the Non secure interrupt to wake the CPU */
@@ -517,6 +712,8 @@ int plat_setup_psci_ops(uintptr_t sec_entrypoint,
 	ma35d1_sec_entrypoint = sec_entrypoint;
 	*psci_ops = &plat_arm_psci_pm_ops;
 
+	ma35d1_idle_states_init((void *)MA35D1_DTB_BASE);
+
 	mmio_write_32(CLK_BASE, mmio_read_32(CLK_BASE) | (1 << 9));//ICE DB
 	return 0;
 }
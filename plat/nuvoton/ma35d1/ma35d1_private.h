@@ -56,6 +56,22 @@ void ma35d1_io_setup(void);
 void configure_mmu(void);
 void ma35d1_ddr_init(void);
 void ma35d1_arch_security_setup(void);
+void ma35d1_reg_unlock(void);
+void ma35d1_reg_lock(void);
 int32_t ma35d1_change_pll(int pll);
+int32_t ma35d1_set_cpu_clock(int cpu_freq);
+unsigned int ma35d1_get_cpu_clock(void);
+
+void ma35d1_dvfs_init(void *fdt);
+int ma35d1_dvfs_set(unsigned int mhz);
+
+int ma35d1_use_tsi(void);
+void ma35d1_crypto_engine_init(void);
+void ma35d1_rng_init(void);
+int ma35d1_rng_read(void *buf, size_t len);
+
+#if FIP_DE_AES
+void ma35d1_fip_hash_update(uintptr_t buf, size_t size);
+#endif
 
 #endif /* MA35D1_PRIVATE_H */
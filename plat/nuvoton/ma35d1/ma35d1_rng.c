@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2021 Nuvoton Technology Corp.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <lib/spinlock.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
+#include <platform_def.h>
+
+#include "ma35d1_private.h"
+#include "include/ma35d1_crypto.h"
+#include "include/tsi_cmd.h"
+
+/*
+ * Random numbers for the normal world, from a ChaCha20 DRBG with fast key
+ * erasure: the key is replaced by fresh keystream after every request, so
+ * output already handed out cannot be recomputed from the state.
+ *
+ * The hardware is only used by ma35d1_rng_init() during cold boot, before
+ * OP-TEE or the normal world can own the TSI or the CRYPTO block. It keys
+ * the DRBG with two 256-bit blocks of TRNG output (through the TSI, or the
+ * CRYPTO PRNG in TRNG seed mode when the TSI is disabled), which must
+ * differ as a basic health test. A failed seed leaves the service off.
+ */
+#define RNG_SEED_WORDS		8
+#define RNG_BLOCK_WORDS		16
+#define RNG_REKEY_BLOCKS	1024U
+
+static spinlock_t rng_lock;
+static uint32_t rng_key[RNG_SEED_WORDS];
+static int rng_ready;
+
+/* Written by the TSI, keep it alone in its cache lines */
+static uint32_t rng_seed[2][RNG_SEED_WORDS]
+	__aligned(CACHE_WRITEBACK_GRANULE);
+
+#define ROTL32(v, n)	(((v) << (n)) | ((v) >> (32 - (n))))
+
+#define CHACHA_QR(a, b, c, d)				\
+	do {						\
+		a += b; d ^= a; d = ROTL32(d, 16);	\
+		c += d; b ^= c; b = ROTL32(b, 12);	\
+		a += b; d ^= a; d = ROTL32(d, 8);	\
+		c += d; b ^= c; b = ROTL32(b, 7);	\
+	} while (0)
+
+/* One ChaCha20 block for 'key' at block counter 'ctr', zero nonce */
+static void chacha20_block(const uint32_t key[RNG_SEED_WORDS], uint32_t ctr,
+			   uint32_t out[RNG_BLOCK_WORDS])
+{
+	uint32_t in[RNG_BLOCK_WORDS];
+	int i;
+
+	in[0] = 0x61707865U;
+	in[1] = 0x3320646eU;
+	in[2] = 0x79622d32U;
+	in[3] = 0x6b206574U;
+	for (i = 0; i < RNG_SEED_WORDS; i++)
+		in[4 + i] = key[i];
+	in[12] = ctr;
+	in[13] = 0U;
+	in[14] = 0U;
+	in[15] = 0U;
+
+	memcpy(out, in, sizeof(in));
+	for (i = 0; i < 10; i++) {
+		CHACHA_QR(out[0], out[4], out[8], out[12]);
+		CHACHA_QR(out[1], out[5], out[9], out[13]);
+		CHACHA_QR(out[2], out[6], out[10], out[14]);
+		CHACHA_QR(out[3], out[7], out[11], out[15]);
+		CHACHA_QR(out[0], out[5], out[10], out[15]);
+		CHACHA_QR(out[1], out[6], out[11], out[12]);
+		CHACHA_QR(out[2], out[7], out[8], out[13]);
+		CHACHA_QR(out[3], out[4], out[9], out[14]);
+	}
+	for (i = 0; i < RNG_BLOCK_WORDS; i++)
+		out[i] += in[i];
+
+	zeromem(in, sizeof(in));
+}
+
+/* Replace the key with block 0 of its own keystream */
+static void rng_rekey(void)
+{
+	uint32_t block[RNG_BLOCK_WORDS];
+
+	chacha20_block(rng_key, 0U, block);
+	memcpy(rng_key, block, sizeof(rng_key));
+	zeromem(block, sizeof(block));
+}
+
+static int rng_get_seed(uint32_t *seed)
+{
+	int ret;
+
+	if (!ma35d1_use_tsi())
+		return PRNG_Generate256(1, seed);
+
+	flush_dcache_range((uintptr_t)seed, RNG_SEED_WORDS * sizeof(uint32_t));
+	ret = TSI_TRNG_Gen_Random(RNG_SEED_WORDS, (uint32_t)(uintptr_t)seed);
+	inv_dcache_range((uintptr_t)seed, RNG_SEED_WORDS * sizeof(uint32_t));
+	return ret;
+}
+
+/*
+ * Seed the DRBG. Called once from bl31_platform_setup(), while BL31 is
+ * the only user of the TSI and the CRYPTO block.
+ */
+void ma35d1_rng_init(void)
+{
+	uint32_t any = 0U;
+	int i;
+
+	if (ma35d1_use_tsi() && (TSI_TRNG_Init(0, 0) != 0)) {
+		ERROR("RNG: TRNG init failed\n");
+		return;
+	}
+
+	if ((rng_get_seed(rng_seed[0]) != 0) ||
+	    (rng_get_seed(rng_seed[1]) != 0)) {
+		ERROR("RNG: no seed from the TRNG\n");
+		goto out;
+	}
+	if (memcmp(rng_seed[0], rng_seed[1], sizeof(rng_seed[0])) == 0) {
+		ERROR("RNG: repeated TRNG output\n");
+		goto out;
+	}
+
+	for (i = 0; i < RNG_SEED_WORDS; i++) {
+		rng_key[i] = rng_seed[0][i] ^ rng_seed[1][i];
+		any |= rng_key[i];
+	}
+	rng_ready = (any != 0U);
+
+out:
+	zeromem(rng_seed, sizeof(rng_seed));
+	flush_dcache_range((uintptr_t)rng_seed, sizeof(rng_seed));
+}
+
+/*
+ * Fill 'buf' with 'len' random bytes. Returns 0, or -EIO if the DRBG could
+ * not be seeded.
+ */
+int ma35d1_rng_read(void *buf, size_t len)
+{
+	uint32_t block[RNG_BLOCK_WORDS];
+	uint8_t *dst = buf;
+	uint32_t ctr = 1U;
+	size_t n;
+
+	spin_lock(&rng_lock);
+
+	if (rng_ready == 0) {
+		spin_unlock(&rng_lock);
+		return -EIO;
+	}
+
+	while (len > 0U) {
+		if (ctr == RNG_REKEY_BLOCKS) {
+			rng_rekey();
+			ctr = 1U;
+		}
+		chacha20_block(rng_key, ctr++, block);
+		n = MIN(len, sizeof(block));
+		memcpy(dst, block, n);
+		dst += n;
+		len -= n;
+	}
+	rng_rekey();
+
+	spin_unlock(&rng_lock);
+
+	zeromem(block, sizeof(block));
+	return 0;
+}
@@ -5,9 +5,13 @@
  */
 
 #include <assert.h>
+#include <errno.h>
 
+#include <arch_helpers.h>
 #include <common/debug.h>
 #include <common/runtime_svc.h>
+#include <lib/spinlock.h>
+#include <lib/utils_def.h>
 #include <lib/mmio.h>
 #include <drivers/delay_timer.h>
 #include <tools_share/uuid.h>
@@ -31,16 +35,43 @@ static unsigned int CAPLL_MODE[7] = {
 	0x0000337D,	/* 125 MHz */
 };
 
+/* CA-PLL output of each CAPLL_MODE entry */
+static const unsigned int CAPLL_MHZ[7] = {
+	1000, 800, 700, 600, 500, 250, 125
+};
+
 static uint32_t eppl_div_restore = 0xFFFFFFFF;
 static uint32_t eppl_ctl1 = 0x1, vppl_ctl1 = 0x1;
 
-static __inline void ma35d1_UnlockReg(void)
+/*
+ * Protected register (SYS_RLKTZS) unlock, reference counted so that nested
+ * or concurrent callers only pay for the unlock sequence once and the
+ * registers are relocked when the last of them is done. Shared with the
+ * PSCI code, for every path that runs with the MMU on.
+ */
+static spinlock_t sip_reg_lock;
+static unsigned int sip_reg_unlocked;
+
+void ma35d1_reg_unlock(void)
 {
-	do {
-		mmio_write_32(0x404601A0, 0x59UL);
-		mmio_write_32(0x404601A0, 0x16UL);
-		mmio_write_32(0x404601A0, 0x88UL);
-	} while (mmio_read_32(0x404601A0) == 0UL);
+	spin_lock(&sip_reg_lock);
+	if (sip_reg_unlocked++ == 0U) {
+		do {
+			mmio_write_32(SYS_RLKTZS, 0x59UL);
+			mmio_write_32(SYS_RLKTZS, 0x16UL);
+			mmio_write_32(SYS_RLKTZS, 0x88UL);
+		} while (mmio_read_32(SYS_RLKTZS) == 0UL);
+	}
+	spin_unlock(&sip_reg_lock);
+}
+
+void ma35d1_reg_lock(void)
+{
+	spin_lock(&sip_reg_lock);
+	assert(sip_reg_unlocked != 0U);
+	if (--sip_reg_unlocked == 0U)
+		mmio_write_32(SYS_RLKTZS, 0);
+	spin_unlock(&sip_reg_lock);
 }
 
 uintptr_t ma35d1_plat_sip_handler(uint32_t smc_fid,
@@ -56,10 +87,26 @@ uintptr_t ma35d1_plat_sip_handler(uint32_t smc_fid,
 	SMC_RET1(handle, SMC_UNK);
 }
 
+/*
+ * This function returns the CA-PLL frequency in MHz, or 0 if the PLL is not
+ * set to one of the CAPLL_MODE settings
+ */
+unsigned int ma35d1_get_cpu_clock(void)
+{
+	uint32_t ctl = mmio_read_32(CLK_PLL0CTL0);
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(CAPLL_MODE); i++) {
+		if (ctl == CAPLL_MODE[i])
+			return CAPLL_MHZ[i];
+	}
+	return 0;
+}
+
 /*
  * This function changes the CPU PLL
  */
-static int32_t ma35d1_set_cpu_clock(int cpu_freq)
+int32_t ma35d1_set_cpu_clock(int cpu_freq)
 {
 	uint64_t timeout;
 	uint32_t index = 2; /* 500 MHz */
@@ -119,6 +166,185 @@ static int32_t ma35d1_set_cpu_clock(int cpu_freq)
 	return 0;
 }
 
+static uintptr_t sip_pmic(u_register_t x1, u_register_t x2,
+			  u_register_t x3, void *handle)
+{
+	uint32_t volt = (uint32_t)x2;
+
+	if (volt == 0) {
+		volt = ma35d1_get_pmic(x1);
+	} else if (volt != ma35d1_get_pmic(x1)) {
+		ma35d1_set_pmic(x1, x2);
+	}
+	SMC_RET1(handle, volt);
+}
+
+static uintptr_t sip_cpu_clk(u_register_t x1, u_register_t x2,
+			     u_register_t x3, void *handle)
+{
+	int CPU_CLK;
+	int ret;
+
+	if ((uint32_t)x1 == 1000)
+		CPU_CLK = CPU_PLL_1G;
+	else if ((uint32_t)x1 == 800)
+		CPU_CLK = CPU_PLL_800;
+	else if ((uint32_t)x1 == 700)
+		CPU_CLK = CPU_PLL_700;
+	else if ((uint32_t)x1 == 600)
+		CPU_CLK = CPU_PLL_600;
+	else if ((uint32_t)x1 == 500)
+		CPU_CLK = CPU_PLL_500;
+	else if ((uint32_t)x1 == 250)
+		CPU_CLK = CPU_PLL_250;
+	else if ((uint32_t)x1 == 125)
+		CPU_CLK = CPU_PLL_125;
+	else
+		CPU_CLK = CPU_PLL_500;
+
+	ret = ma35d1_set_cpu_clock(CPU_CLK);
+	if (ret == 1) {
+		WARN("Set CPU clock %ld Fail !!\n", x1);
+	}
+	SMC_RET1(handle, ret);
+}
+
+static uintptr_t sip_set_epll(u_register_t x1, u_register_t x2,
+			      u_register_t x3, void *handle)
+{
+	if (eppl_div_restore == 0xFFFFFFFF)
+		eppl_div_restore = mmio_read_32(CLK_PLL4CTL1);
+	if ((uint32_t)x1 == NVT_SIP_SVC_EPLL_DIV_BY_2)
+		mmio_write_32(CLK_PLL4CTL1, eppl_div_restore + 0x10);
+	else if ((uint32_t)x1 == NVT_SIP_SVC_EPLL_DIV_BY_4)
+		mmio_write_32(CLK_PLL4CTL1, eppl_div_restore + 0x20);
+	else if ((uint32_t)x1 == NVT_SIP_SVC_EPLL_DIV_BY_8)
+		mmio_write_32(CLK_PLL4CTL1, eppl_div_restore + 0x30);
+	else {
+		mmio_write_32(CLK_PLL4CTL1, eppl_div_restore);
+		eppl_div_restore = 0xFFFFFFFF;
+	}
+	SMC_RET2(handle, 0, mmio_read_32(CLK_PLL4CTL1));
+}
+
+static uintptr_t sip_low_speed(u_register_t x1, u_register_t x2,
+			       u_register_t x3, void *handle)
+{
+	if ((uint32_t)x1 == 0) {
+		ma35d1_set_cpu_clock(CPU_PLL_500);
+		if ((mmio_read_32(SYS_CHIPCFG) & (1 << 8)) == 0)
+			TSI_Set_Clock(0x80235A);
+		mmio_write_32(CLK_PLL4CTL1, eppl_ctl1);
+		mmio_write_32(CLK_PLL5CTL1, vppl_ctl1);
+	} else {
+		ma35d1_set_cpu_clock(CPU_PLL_125);
+		if ((mmio_read_32(SYS_CHIPCFG) & (1 << 8)) == 0)
+			TSI_Set_Clock(0x802312);
+		eppl_ctl1 = mmio_read_32(CLK_PLL4CTL1);
+		vppl_ctl1 = mmio_read_32(CLK_PLL5CTL1);
+		mmio_write_32(CLK_PLL4CTL1, eppl_ctl1 | 0x70);
+		mmio_write_32(CLK_PLL5CTL1, vppl_ctl1 | 0x70);
+	}
+	SMC_RET1(handle, 0);
+}
+
+static uintptr_t sip_chip_reset(u_register_t x1, u_register_t x2,
+				u_register_t x3, void *handle)
+{
+	mmio_write_32(SYS_IPRST0, 0x1);
+	mmio_write_32(SYS_IPRST0, 0x0);
+	WARN("SIP_CHIP_RESET not work!\n");
+	SMC_RET1(handle, 0);
+}
+
+static uintptr_t sip_version(u_register_t x1, u_register_t x2,
+			     u_register_t x3, void *handle)
+{
+	/* Return the version of current implementation */
+	SMC_RET3(handle, 0, NVT_SIP_SVC_VERSION_MAJOR,
+		NVT_SIP_SVC_VERSION_MINOR);
+}
+
+static uintptr_t sip_rng(u_register_t x1, u_register_t x2,
+			 u_register_t x3, void *handle)
+{
+	uint64_t rnd[NVT_SIP_SVC_RNG_MAX_WORDS] = { 0 };
+
+	/* x1: number of 64-bit random words, returned in x1..x3 */
+	if ((x1 == 0) || (x1 > NVT_SIP_SVC_RNG_MAX_WORDS))
+		SMC_RET1(handle, RK_SIP_E_INVALID_PARAM);
+	if (ma35d1_rng_read(rnd, x1 * sizeof(uint64_t)) != 0)
+		SMC_RET1(handle, RK_SIP_E_NOT_AVAILABLE);
+	SMC_RET4(handle, 0, rnd[0], rnd[1], rnd[2]);
+}
+
+static uintptr_t sip_rng_batch(u_register_t x1, u_register_t x2,
+			       u_register_t x3, void *handle)
+{
+	/* x1: non-secure buffer, x2: length in bytes */
+	if ((x2 == 0) || (x2 > NVT_SIP_SVC_RNG_BATCH_MAX) ||
+	    (x1 < MA35D1_DRAM_BASE) ||
+	    (x1 > (MA35D1_DRAM_BASE + MA35D1_DRAM_SIZE - x2)))
+		SMC_RET1(handle, RK_SIP_E_INVALID_PARAM);
+	if (ma35d1_rng_read((void *)x1, x2) != 0)
+		SMC_RET1(handle, RK_SIP_E_NOT_AVAILABLE);
+	flush_dcache_range(x1, x2);
+	SMC_RET1(handle, 0);
+}
+
+static uintptr_t sip_set_opp(u_register_t x1, u_register_t x2,
+			     u_register_t x3, void *handle)
+{
+	/* x1: target MHz, 0 to query. Returns status, MHz and VDD_CPU in uV */
+	int ret = 0;
+
+	if (x1 != 0) {
+		ret = ma35d1_dvfs_set((unsigned int)x1);
+		if (ret == -EINVAL)
+			ret = RK_SIP_E_INVALID_PARAM;
+		else if (ret != 0)
+			ret = RK_SIP_E_NOT_AVAILABLE;
+	}
+	SMC_RET3(handle, ret, ma35d1_get_cpu_clock(),
+		 ma35d1_get_pmic(VOL_CPU) * 10000);
+}
+
+/*
+ * SiP calls, indexed by function number.
+ * SIP_F_UNLOCK: the call writes protected registers, unlock them around it.
+ * SIP_F_SERIAL: the call changes shared clock/PLL state, run one at a time.
+ * Calls with neither flag run without touching SYS_RLKTZS or taking a lock.
+ */
+#define SIP_F_UNLOCK		(1U << 0)
+#define SIP_F_SERIAL		(1U << 1)
+
+typedef uintptr_t (*sip_call_t)(u_register_t x1, u_register_t x2,
+				u_register_t x3, void *handle);
+
+typedef struct {
+	uint32_t fid;
+	uint32_t flags;
+	sip_call_t call;
+} sip_desc_t;
+
+#define SIP_DESC(_fid, _flags, _call)			\
+	[(_fid) & FUNCID_NUM_MASK] = {			\
+		.fid = (_fid), .flags = (_flags), .call = (_call) }
+
+static const sip_desc_t sip_descs[] = {
+	SIP_DESC(SIP_SVC_PMIC, SIP_F_SERIAL, sip_pmic),
+	SIP_DESC(SIP_CPU_CLK, SIP_F_UNLOCK | SIP_F_SERIAL, sip_cpu_clk),
+	SIP_DESC(SIP_SET_EPLL, SIP_F_UNLOCK | SIP_F_SERIAL, sip_set_epll),
+	SIP_DESC(SIP_LOW_SPEED, SIP_F_UNLOCK | SIP_F_SERIAL, sip_low_speed),
+	SIP_DESC(SIP_CHIP_RESET, SIP_F_UNLOCK, sip_chip_reset),
+	SIP_DESC(SIP_SVC_VERSION, 0, sip_version),
+	SIP_DESC(SIP_SVC_RNG, 0, sip_rng),
+	SIP_DESC(SIP_SVC_RNG_BATCH, 0, sip_rng_batch),
+	SIP_DESC(SIP_SVC_SET_OPP, SIP_F_UNLOCK | SIP_F_SERIAL, sip_set_opp),
+};
+
+static spinlock_t sip_serial_lock;
+
 /*
  * This function is responsible for handling all SiP calls from the NS world
  */
@@ -131,116 +357,32 @@ uintptr_t sip_smc_handler(uint32_t smc_fid,
 			  void *handle,
 			  u_register_t flags)
 {
-	uint32_t ns;
-	uint32_t volt;
-	int ret;
-	int CPU_CLK = 0;
-
-	/* unlock */
-	mmio_write_32(SYS_RLKTZS, 0x59);
-	mmio_write_32(SYS_RLKTZS, 0x16);
-	mmio_write_32(SYS_RLKTZS, 0x88);
-
-	// INFO("TFA SIP - 0x%x, %ld, %ld\n", smc_fid, x1, x2);
+	const sip_desc_t *desc;
+	uint32_t num = smc_fid & FUNCID_NUM_MASK;
+	uintptr_t ret;
 
 	/* Determine which security state this SMC originated from */
-	ns = is_caller_non_secure(flags);
-	if (!ns)
+	if (!is_caller_non_secure(flags))
 		SMC_RET1(handle, SMC_UNK);
 
-	switch (smc_fid) {
-	case SIP_SVC_PMIC:
-		volt = (uint32_t)x2;
-		if (volt == 0)
-                       volt = ma35d1_get_pmic(x1);
-		else {
-			if (volt != ma35d1_get_pmic(x1))
-				ma35d1_set_pmic(x1, x2);
-		}
-		mmio_write_32(SYS_RLKTZS, 0);
-		SMC_RET1(handle, volt);
-
-	case SIP_CPU_CLK:
-		if ((uint32_t)x1 == 1000)
-			CPU_CLK = CPU_PLL_1G;
-		else if ((uint32_t)x1 == 800)
-			CPU_CLK = CPU_PLL_800;
-		else if ((uint32_t)x1 == 700)
-			CPU_CLK = CPU_PLL_700;
-		else if ((uint32_t)x1 == 600)
-			CPU_CLK = CPU_PLL_600;
-		else if ((uint32_t)x1 == 500)
-			CPU_CLK = CPU_PLL_500;
-		else if ((uint32_t)x1 == 250)
-			CPU_CLK = CPU_PLL_250;
-		else if ((uint32_t)x1 == 125)
-			CPU_CLK = CPU_PLL_125;
-		else
-			CPU_CLK = CPU_PLL_500;
-
-		ret = ma35d1_set_cpu_clock(CPU_CLK);
-		if (ret == 1) {
-			WARN("Set CPU clock %ld Fail !!\n", x1);
-		}
-		mmio_write_32(SYS_RLKTZS, 0);
-		SMC_RET1(handle, ret);
-
-	case SIP_SET_EPLL:
-		// INFO("TFA SIP - CLK_PLL4CTL1 = 0x%x, restore = 0x%x\n", mmio_read_32(CLK_PLL4CTL1), eppl_div_restore);
-		if (eppl_div_restore == 0xFFFFFFFF)
-			eppl_div_restore = mmio_read_32(CLK_PLL4CTL1);
-		if ((uint32_t)x1 == NVT_SIP_SVC_EPLL_DIV_BY_2)
-			mmio_write_32(CLK_PLL4CTL1, eppl_div_restore + 0x10);
-		else if ((uint32_t)x1 == NVT_SIP_SVC_EPLL_DIV_BY_4)
-			mmio_write_32(CLK_PLL4CTL1, eppl_div_restore + 0x20);
-		else if ((uint32_t)x1 == NVT_SIP_SVC_EPLL_DIV_BY_8)
-			mmio_write_32(CLK_PLL4CTL1, eppl_div_restore + 0x30);
-		else {
-			mmio_write_32(CLK_PLL4CTL1, eppl_div_restore);
-			eppl_div_restore = 0xFFFFFFFF;
-		}
-		mmio_write_32(SYS_RLKTZS, 0);
-		SMC_RET2(handle, 0, mmio_read_32(CLK_PLL4CTL1));
-
-	case SIP_LOW_SPEED:
-		if ((uint32_t)x1 == 0) {
-			// INFO("Leave low speed mode\n");
-			ma35d1_set_cpu_clock(CPU_PLL_500);
-			if ((mmio_read_32(SYS_CHIPCFG) & (1 << 8)) == 0)
-				TSI_Set_Clock(0x80235A);
-			mmio_write_32(CLK_PLL4CTL1, eppl_ctl1);
-			mmio_write_32(CLK_PLL5CTL1, vppl_ctl1);
-		} else {
-			// INFO("Enter low speed mode\n");
-			ma35d1_set_cpu_clock(CPU_PLL_125);
-			if ((mmio_read_32(SYS_CHIPCFG) & (1 << 8)) == 0)
-				TSI_Set_Clock(0x802312);
-			eppl_ctl1 = mmio_read_32(CLK_PLL4CTL1);
-			vppl_ctl1 = mmio_read_32(CLK_PLL5CTL1);
-			mmio_write_32(CLK_PLL4CTL1, eppl_ctl1 | 0x70);
-			mmio_write_32(CLK_PLL5CTL1, vppl_ctl1 | 0x70);
-		}
-		mmio_write_32(SYS_RLKTZS, 0);
-		SMC_RET1(handle, 0);
+	if ((num >= ARRAY_SIZE(sip_descs)) || (sip_descs[num].fid != smc_fid))
+		return ma35d1_plat_sip_handler(smc_fid, x1, x2, x3, x4,
+			cookie, handle, flags);
 
-	case SIP_CHIP_RESET:
-		ma35d1_UnlockReg();
-		mmio_write_32(SYS_IPRST0, 0x1);
-		mmio_write_32(SYS_IPRST0, 0x0);
-		WARN("SIP_CHIP_RESET not work!\n");
-		SMC_RET1(handle, 0);
+	desc = &sip_descs[num];
+	if (desc->flags & SIP_F_SERIAL)
+		spin_lock(&sip_serial_lock);
+	if (desc->flags & SIP_F_UNLOCK)
+		ma35d1_reg_unlock();
 
-	case SIP_SVC_VERSION:
-		/* Return the version of current implementation */
-		SMC_RET3(handle, 0, NVT_SIP_SVC_VERSION_MAJOR,
-			NVT_SIP_SVC_VERSION_MINOR);
+	ret = desc->call(x1, x2, x3, handle);
 
-	default:
-		mmio_write_32(SYS_RLKTZS, 0);
-		return ma35d1_plat_sip_handler(smc_fid, x1, x2, x3, x4,
-			cookie, handle, flags);
-	};
+	if (desc->flags & SIP_F_UNLOCK)
+		ma35d1_reg_lock();
+	if (desc->flags & SIP_F_SERIAL)
+		spin_unlock(&sip_serial_lock);
 
+	return ret;
 }
 
 /* Define a runtime service descriptor for fast SMC calls */
@@ -26,6 +26,13 @@ $(eval $(call add_define,MA35D1_MAX_CPUS_PER_CLUSTER))
 $(eval $(call add_define,MA35D1_MAX_PE_PER_CPU))
 $(eval $(call add_define,MA35D1_INTERCONNECT_DRIVER))
 
+# Align FIP entries so block aligned reads can bypass the io_block buffer
+FIP_ALIGN		:= 512
+
+# Word-wide memcpy/memset for io_block bounce copies and SCP_BL2 loading.
+# Off until lib/libc/aarch64/test has passed on AArch64 for this release.
+LIBC_OPTIMIZED_MEMFUNCS	?= 0
+
 FIP_DE_AES ?= 0
 $(eval $(call add_define,FIP_DE_AES))
 
@@ -175,6 +182,8 @@ BL31_SOURCES		+=	drivers/arm/smmu/smmu_v3.c			\
 				plat/nuvoton/ma35d1/ma35d1_pm.c		\
 				plat/nuvoton/ma35d1/ma35d1_topology.c		\
 				plat/nuvoton/ma35d1/ma35d1_sip_svc.c            \
+				plat/nuvoton/ma35d1/ma35d1_rng.c		\
+				plat/nuvoton/ma35d1/ma35d1_dvfs.c		\
 				${MA35D1_GIC_SOURCES}				\
 				${MA35D1_SECURITY_SOURCES}			\
 
@@ -200,6 +209,9 @@ GENERATE_COT		:= 1
 NVT_USE_RSA		:= 0
 NVT_USE_ECDSA		:= 1
 
+# Hash and ECDSA verification on the CRYPTO/TSI hardware, ECDSA keys only
+NVT_CRYPTO_HW		:= ${NVT_USE_ECDSA}
+
 MBEDTLS_SHA256_SMALLER	:= 0
 
 # Set the default algorithm for the generation of Trusted Board Boot keys
@@ -212,7 +224,20 @@ endif
 
 MBEDTLS_DIR=../mbedtls-2.18
 
+ifeq (${NVT_CRYPTO_HW},1)
+ifeq (${NVT_USE_RSA},1)
+$(error "NVT_CRYPTO_HW does not support RSA keys")
+endif
+# mbed TLS only parses ASN.1 here and none of those calls allocate, so the
+# heap steps logged by verify_signature() and verify_hash() peak at 0.
+# Keep a token heap so that a stray allocation fails cleanly.
+TF_MBEDTLS_HEAP_ARENA	:= 1
+TF_MBEDTLS_HEAP_SIZE	:= 256
+include drivers/auth/mbedtls/mbedtls_common.mk
+BL2_SOURCES		+=	plat/nuvoton/ma35d1/ma35d1_crypto_lib.c
+else
 include drivers/auth/mbedtls/mbedtls_crypto.mk
+endif
 include drivers/auth/mbedtls/mbedtls_x509.mk
 
 BL2_SOURCES		+=	drivers/auth/auth_mod.c			\